@@ -0,0 +1,41 @@
+# Runs the device benchmarks on lavapipe, Mesa's software ICD, and checks that
+# every table made it into the JSON output. Skipped when no lavapipe manifest
+# is installed.
+#
+# cmake -DSHOW_VK=<show-vk> -P lavapipe-test.cmake
+
+file(GLOB manifests
+	"/usr/share/vulkan/icd.d/lvp_icd*.json"
+	"/usr/local/share/vulkan/icd.d/lvp_icd*.json"
+	"/etc/vulkan/icd.d/lvp_icd*.json")
+if(NOT manifests)
+	message("lavapipe ICD manifest not found")
+	return()
+endif()
+list(GET manifests 0 manifest)
+
+# The ICD is opened directly, like the mock, so no loader has to be installed.
+file(READ "${manifest}" contents)
+if(NOT contents MATCHES "\"library_path\"[ \t\r\n]*:[ \t\r\n]*\"([^\"]+)\"")
+	message(FATAL_ERROR "No library_path in ${manifest}")
+endif()
+set(library "${CMAKE_MATCH_1}")
+# Relative paths are relative to the manifest; bare names go to the library search path.
+if(NOT IS_ABSOLUTE "${library}" AND library MATCHES "/")
+	get_filename_component(directory "${manifest}" DIRECTORY)
+	set(library "${directory}/${library}")
+endif()
+
+execute_process(
+	COMMAND "${SHOW_VK}" "--vulkan-library=${library}" --format=json
+		--device-memory-bench --device-queue-bench --device-pipeline-bench
+	RESULT_VARIABLE result
+	OUTPUT_VARIABLE output)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "show-vk failed on ${library}: ${result}")
+endif()
+foreach(key memoryBench queueBench pipelineBench)
+	if(NOT output MATCHES "\"${key}\"")
+		message(FATAL_ERROR "No ${key} table in the output of show-vk on ${library}")
+	endif()
+endforeach()
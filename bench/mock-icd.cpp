@@ -0,0 +1,633 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#if defined(_WIN32)
+#define SHW_MOCK_EXPORT extern "C" __declspec(dllexport)
+#else
+#define SHW_MOCK_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+// Minimal ICD for show-vk-bench and the smoke tests: as many instance
+// extensions as SHOW_VK_MOCK_EXTENSIONS asks for, so loader enumeration can
+// be measured on machines without a GPU, and one Vulkan 1.0 CPU device with
+// just enough of a compute path for the --device-*-bench modes. Memory is
+// plain host memory and submits run on the calling thread: dispatches do
+// nothing, timestamps read the host clock and fences signal before
+// vkQueueSubmit returns.
+namespace {
+    constexpr std::uint32_t loaderInterfaceVersion{ 5 };
+    // The loader checks for this value in the first word of dispatchable handles.
+    constexpr std::uintptr_t icdLoaderMagic{ 0x01CDC0DE };
+    constexpr std::uint32_t mockVendorId{ 0x10000 };
+    constexpr std::uint32_t mockDeviceId{ 1 };
+    constexpr std::uint8_t mockCacheUuid[VK_UUID_SIZE]{ 's', 'h', 'o', 'w', '-', 'v', 'k', '-', 'm', 'o', 'c', 'k' };
+    // Family 0 does everything and has timestamps; family 1 only transfers.
+    constexpr std::uint32_t queueFamilyCount{ 2 };
+
+    struct MockInstance {
+        std::uintptr_t loaderData{ icdLoaderMagic };
+    };
+
+    struct MockPhysicalDevice {
+        std::uintptr_t loaderData{ icdLoaderMagic };
+    } physicalDevice;
+
+    struct MockQueue {
+        std::uintptr_t loaderData{ icdLoaderMagic };
+    };
+
+    struct MockDevice {
+        std::uintptr_t loaderData{ icdLoaderMagic };
+        MockQueue queues[queueFamilyCount];
+    };
+
+    struct MockQueryPool {
+        std::vector<std::uint64_t> values;
+        std::vector<bool> available;
+    };
+
+    // What a submit has to replay; binds and dispatches leave nothing behind.
+    struct MockCommand {
+        enum class Kind { ResetQueries, WriteTimestamp };
+        Kind kind;
+        MockQueryPool* pool;
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    struct MockCommandBuffer {
+        std::uintptr_t loaderData{ icdLoaderMagic };
+        std::vector<MockCommand> commands;
+    };
+
+    struct MockCommandPool {
+        std::vector<std::unique_ptr<MockCommandBuffer>> buffers;
+    };
+
+    struct MockFence {
+        bool signaled;
+    };
+
+    struct MockMemory {
+        std::unique_ptr<unsigned char[]> data;
+    };
+
+    struct MockShaderModule {
+        std::uint64_t hash;
+    };
+
+    // A serialized cache is a VkPipelineCacheHeaderVersionOne followed by the
+    // hashes of the shaders it has seen.
+    struct MockPipelineCache {
+        std::mutex mutex;
+        std::set<std::uint64_t> hashes;
+    };
+
+    // Layouts and pipelines carry no state.
+    struct MockObject {};
+
+    // Non-dispatchable handles are pointers on 64-bit targets and integers on 32-bit ones.
+    template<typename Handle, typename Object>
+    Handle toHandle(Object* object) {
+        if constexpr (std::is_pointer_v<Handle>) {
+            return reinterpret_cast<Handle>(object);
+        }
+        else {
+            return static_cast<Handle>(reinterpret_cast<std::uintptr_t>(object));
+        }
+    }
+
+    template<typename Object, typename Handle>
+    Object* fromHandle(Handle handle) {
+        if constexpr (std::is_pointer_v<Handle>) {
+            return reinterpret_cast<Object*>(handle);
+        }
+        else {
+            return reinterpret_cast<Object*>(static_cast<std::uintptr_t>(handle));
+        }
+    }
+
+    std::uint64_t hostNanoseconds() {
+        const auto now{ std::chrono::steady_clock::now().time_since_epoch() };
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    }
+
+    const std::vector<VkExtensionProperties>& mockExtensions() {
+        static const std::vector<VkExtensionProperties> extensions{ [] {
+            const char* countText{ std::getenv("SHOW_VK_MOCK_EXTENSIONS") };
+            const auto count{ countText != nullptr ? std::strtoul(countText, nullptr, 10) : 0ul };
+            std::vector<VkExtensionProperties> result(count);
+            for (unsigned long i{}; i < count; ++i) {
+                std::snprintf(result[i].extensionName, VK_MAX_EXTENSION_NAME_SIZE, "VK_MOCK_extension_%05lu", i);
+                result[i].specVersion = 1;
+            }
+            return result;
+        }() };
+        return extensions;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL enumerateInstanceExtensionProperties(const char* layerName,
+        std::uint32_t* count, VkExtensionProperties* properties) {
+        if (layerName != nullptr) {
+            return VK_ERROR_LAYER_NOT_PRESENT;
+        }
+        const auto& extensions{ mockExtensions() };
+        const auto available{ static_cast<std::uint32_t>(extensions.size()) };
+        if (properties == nullptr) {
+            *count = available;
+            return VK_SUCCESS;
+        }
+        const std::uint32_t copied{ *count < available ? *count : available };
+        std::memcpy(properties, extensions.data(), copied * sizeof(VkExtensionProperties));
+        *count = copied;
+        return copied < available ? VK_INCOMPLETE : VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL enumerateInstanceVersion(std::uint32_t* version) {
+        *version = VK_API_VERSION_1_3;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createInstance(const VkInstanceCreateInfo*,
+        const VkAllocationCallbacks*, VkInstance* instance) {
+        *instance = reinterpret_cast<VkInstance>(new MockInstance);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyInstance(VkInstance instance, const VkAllocationCallbacks*) {
+        delete reinterpret_cast<MockInstance*>(instance);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL enumeratePhysicalDevices(VkInstance, std::uint32_t* count, VkPhysicalDevice* devices) {
+        if (devices == nullptr) {
+            *count = 1;
+            return VK_SUCCESS;
+        }
+        if (*count == 0) {
+            return VK_INCOMPLETE;
+        }
+        devices[0] = reinterpret_cast<VkPhysicalDevice>(&physicalDevice);
+        *count = 1;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties* properties) {
+        *properties = {};
+        properties->apiVersion = VK_API_VERSION_1_0;
+        properties->driverVersion = 1;
+        properties->vendorID = mockVendorId;
+        properties->deviceID = mockDeviceId;
+        properties->deviceType = VK_PHYSICAL_DEVICE_TYPE_CPU;
+        std::snprintf(properties->deviceName, VK_MAX_PHYSICAL_DEVICE_NAME_SIZE, "show-vk mock device");
+        std::memcpy(properties->pipelineCacheUUID, mockCacheUuid, VK_UUID_SIZE);
+        // The minimums the specification requires, where the benches look.
+        VkPhysicalDeviceLimits& limits{ properties->limits };
+        limits.maxImageDimension2D = 4096;
+        limits.maxMemoryAllocationCount = 4096;
+        limits.maxBoundDescriptorSets = 4;
+        limits.maxComputeWorkGroupCount[0] = 65535;
+        limits.maxComputeWorkGroupCount[1] = 65535;
+        limits.maxComputeWorkGroupCount[2] = 65535;
+        limits.maxComputeWorkGroupInvocations = 128;
+        limits.maxComputeWorkGroupSize[0] = 128;
+        limits.maxComputeWorkGroupSize[1] = 128;
+        limits.maxComputeWorkGroupSize[2] = 64;
+        limits.minMemoryMapAlignment = 64;
+        limits.nonCoherentAtomSize = 256;
+        limits.timestampComputeAndGraphics = VK_TRUE;
+        limits.timestampPeriod = 1.0f;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceProperties2(VkPhysicalDevice device, VkPhysicalDeviceProperties2* properties) {
+        getPhysicalDeviceProperties(device, &properties->properties);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceFeatures(VkPhysicalDevice, VkPhysicalDeviceFeatures* features) {
+        *features = {};
+        features->robustBufferAccess = VK_TRUE;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceFeatures2(VkPhysicalDevice device, VkPhysicalDeviceFeatures2* features) {
+        getPhysicalDeviceFeatures(device, &features->features);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceMemoryProperties(VkPhysicalDevice, VkPhysicalDeviceMemoryProperties* memory) {
+        *memory = {};
+        memory->memoryHeapCount = 1;
+        memory->memoryHeaps[0] = { 256ull << 20, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+        // One coherent and one cached, non-coherent type, so both memory bench paths run.
+        memory->memoryTypeCount = 2;
+        memory->memoryTypes[0] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+            | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0 };
+        memory->memoryTypes[1] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+            | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 0 };
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice, std::uint32_t* count,
+        VkQueueFamilyProperties* families) {
+        constexpr VkQueueFamilyProperties mockFamilies[queueFamilyCount]{
+            { VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, 1, 64, { 1, 1, 1 } },
+            { VK_QUEUE_TRANSFER_BIT, 1, 0, { 1, 1, 1 } },
+        };
+        if (families == nullptr) {
+            *count = queueFamilyCount;
+            return;
+        }
+        *count = *count < queueFamilyCount ? *count : queueFamilyCount;
+        std::memcpy(families, mockFamilies, *count * sizeof(VkQueueFamilyProperties));
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceFormatProperties(VkPhysicalDevice, VkFormat format, VkFormatProperties* properties) {
+        *properties = {};
+        if (format == VK_FORMAT_R8G8B8A8_UNORM) {
+            properties->linearTilingFeatures = VK_FORMAT_FEATURE_TRANSFER_SRC_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+            properties->optimalTilingFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT
+                | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+            properties->bufferFeatures = VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT | VK_FORMAT_FEATURE_UNIFORM_TEXEL_BUFFER_BIT;
+        }
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceFormatProperties2(VkPhysicalDevice device, VkFormat format, VkFormatProperties2* properties) {
+        getPhysicalDeviceFormatProperties(device, format, &properties->formatProperties);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL enumerateDeviceExtensionProperties(VkPhysicalDevice, const char* layerName,
+        std::uint32_t* count, VkExtensionProperties*) {
+        *count = 0;
+        return layerName != nullptr ? VK_ERROR_LAYER_NOT_PRESENT : VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createDevice(VkPhysicalDevice, const VkDeviceCreateInfo*,
+        const VkAllocationCallbacks*, VkDevice* device) {
+        *device = reinterpret_cast<VkDevice>(new MockDevice);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyDevice(VkDevice device, const VkAllocationCallbacks*) {
+        delete reinterpret_cast<MockDevice*>(device);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL getDeviceQueue(VkDevice device, std::uint32_t family, std::uint32_t, VkQueue* queue) {
+        *queue = reinterpret_cast<VkQueue>(&reinterpret_cast<MockDevice*>(device)->queues[family]);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL deviceWaitIdle(VkDevice) {
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL allocateMemory(VkDevice, const VkMemoryAllocateInfo* info,
+        const VkAllocationCallbacks*, VkDeviceMemory* memory) {
+        auto* allocation{ new MockMemory };
+        allocation->data.reset(new (std::nothrow) unsigned char[info->allocationSize]);
+        if (!allocation->data) {
+            delete allocation;
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+        *memory = toHandle<VkDeviceMemory>(allocation);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL freeMemory(VkDevice, VkDeviceMemory memory, const VkAllocationCallbacks*) {
+        delete fromHandle<MockMemory>(memory);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL mapMemory(VkDevice, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize,
+        VkMemoryMapFlags, void** data) {
+        *data = fromHandle<MockMemory>(memory)->data.get() + offset;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL unmapMemory(VkDevice, VkDeviceMemory) {}
+
+    // Host memory is always coherent, so flushing and invalidating are free.
+    VKAPI_ATTR VkResult VKAPI_CALL syncMappedMemoryRanges(VkDevice, std::uint32_t, const VkMappedMemoryRange*) {
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createFence(VkDevice, const VkFenceCreateInfo* info,
+        const VkAllocationCallbacks*, VkFence* fence) {
+        *fence = toHandle<VkFence>(new MockFence{ (info->flags & VK_FENCE_CREATE_SIGNALED_BIT) != 0 });
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyFence(VkDevice, VkFence fence, const VkAllocationCallbacks*) {
+        delete fromHandle<MockFence>(fence);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL resetFences(VkDevice, std::uint32_t count, const VkFence* fences) {
+        for (std::uint32_t i{}; i < count; ++i) {
+            fromHandle<MockFence>(fences[i])->signaled = false;
+        }
+        return VK_SUCCESS;
+    }
+
+    // Submits complete before they return, so an unsignaled fence never will be.
+    VKAPI_ATTR VkResult VKAPI_CALL waitForFences(VkDevice, std::uint32_t count, const VkFence* fences, VkBool32, std::uint64_t) {
+        for (std::uint32_t i{}; i < count; ++i) {
+            if (!fromHandle<MockFence>(fences[i])->signaled) {
+                return VK_TIMEOUT;
+            }
+        }
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL queueSubmit(VkQueue, std::uint32_t count, const VkSubmitInfo* submits, VkFence fence) {
+        for (std::uint32_t i{}; i < count; ++i) {
+            for (std::uint32_t j{}; j < submits[i].commandBufferCount; ++j) {
+                const auto* buffer{ reinterpret_cast<const MockCommandBuffer*>(submits[i].pCommandBuffers[j]) };
+                for (const MockCommand& command : buffer->commands) {
+                    if (command.kind == MockCommand::Kind::WriteTimestamp) {
+                        command.pool->values[command.first] = hostNanoseconds();
+                        command.pool->available[command.first] = true;
+                        continue;
+                    }
+                    for (std::uint32_t query{ command.first }; query < command.first + command.count; ++query) {
+                        command.pool->available[query] = false;
+                    }
+                }
+            }
+        }
+        if (fence != VK_NULL_HANDLE) {
+            fromHandle<MockFence>(fence)->signaled = true;
+        }
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createCommandPool(VkDevice, const VkCommandPoolCreateInfo*,
+        const VkAllocationCallbacks*, VkCommandPool* pool) {
+        *pool = toHandle<VkCommandPool>(new MockCommandPool);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyCommandPool(VkDevice, VkCommandPool pool, const VkAllocationCallbacks*) {
+        delete fromHandle<MockCommandPool>(pool);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL allocateCommandBuffers(VkDevice, const VkCommandBufferAllocateInfo* info, VkCommandBuffer* buffers) {
+        auto* pool{ fromHandle<MockCommandPool>(info->commandPool) };
+        for (std::uint32_t i{}; i < info->commandBufferCount; ++i) {
+            pool->buffers.push_back(std::make_unique<MockCommandBuffer>());
+            buffers[i] = reinterpret_cast<VkCommandBuffer>(pool->buffers.back().get());
+        }
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL beginCommandBuffer(VkCommandBuffer buffer, const VkCommandBufferBeginInfo*) {
+        reinterpret_cast<MockCommandBuffer*>(buffer)->commands.clear();
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL endCommandBuffer(VkCommandBuffer) {
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL cmdBindPipeline(VkCommandBuffer, VkPipelineBindPoint, VkPipeline) {}
+
+    VKAPI_ATTR void VKAPI_CALL cmdDispatch(VkCommandBuffer, std::uint32_t, std::uint32_t, std::uint32_t) {}
+
+    VKAPI_ATTR void VKAPI_CALL cmdResetQueryPool(VkCommandBuffer buffer, VkQueryPool pool, std::uint32_t first, std::uint32_t count) {
+        reinterpret_cast<MockCommandBuffer*>(buffer)->commands.push_back(
+            { MockCommand::Kind::ResetQueries, fromHandle<MockQueryPool>(pool), first, count });
+    }
+
+    VKAPI_ATTR void VKAPI_CALL cmdWriteTimestamp(VkCommandBuffer buffer, VkPipelineStageFlagBits, VkQueryPool pool, std::uint32_t query) {
+        reinterpret_cast<MockCommandBuffer*>(buffer)->commands.push_back(
+            { MockCommand::Kind::WriteTimestamp, fromHandle<MockQueryPool>(pool), query, 1 });
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createQueryPool(VkDevice, const VkQueryPoolCreateInfo* info,
+        const VkAllocationCallbacks*, VkQueryPool* pool) {
+        auto* queries{ new MockQueryPool };
+        queries->values.resize(info->queryCount);
+        queries->available.resize(info->queryCount);
+        *pool = toHandle<VkQueryPool>(queries);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyQueryPool(VkDevice, VkQueryPool pool, const VkAllocationCallbacks*) {
+        delete fromHandle<MockQueryPool>(pool);
+    }
+
+    // Only 64-bit results are supported, which is all show-vk asks for.
+    VKAPI_ATTR VkResult VKAPI_CALL getQueryPoolResults(VkDevice, VkQueryPool pool, std::uint32_t first, std::uint32_t count,
+        std::size_t, void* data, VkDeviceSize stride, VkQueryResultFlags) {
+        const auto* queries{ fromHandle<MockQueryPool>(pool) };
+        for (std::uint32_t i{}; i < count; ++i) {
+            if (!queries->available[first + i]) {
+                return VK_NOT_READY;
+            }
+            std::memcpy(static_cast<unsigned char*>(data) + i * stride, &queries->values[first + i], sizeof(std::uint64_t));
+        }
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createShaderModule(VkDevice, const VkShaderModuleCreateInfo* info,
+        const VkAllocationCallbacks*, VkShaderModule* module) {
+        // FNV-1a over the code, so identical modules hit the same cache entry.
+        std::uint64_t hash{ 0xcbf29ce484222325 };
+        const auto* bytes{ reinterpret_cast<const unsigned char*>(info->pCode) };
+        for (std::size_t i{}; i < info->codeSize; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3;
+        }
+        *module = toHandle<VkShaderModule>(new MockShaderModule{ hash });
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyShaderModule(VkDevice, VkShaderModule module, const VkAllocationCallbacks*) {
+        delete fromHandle<MockShaderModule>(module);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createDescriptorSetLayout(VkDevice, const VkDescriptorSetLayoutCreateInfo*,
+        const VkAllocationCallbacks*, VkDescriptorSetLayout* layout) {
+        *layout = toHandle<VkDescriptorSetLayout>(new MockObject);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyDescriptorSetLayout(VkDevice, VkDescriptorSetLayout layout, const VkAllocationCallbacks*) {
+        delete fromHandle<MockObject>(layout);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createPipelineLayout(VkDevice, const VkPipelineLayoutCreateInfo*,
+        const VkAllocationCallbacks*, VkPipelineLayout* layout) {
+        *layout = toHandle<VkPipelineLayout>(new MockObject);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyPipelineLayout(VkDevice, VkPipelineLayout layout, const VkAllocationCallbacks*) {
+        delete fromHandle<MockObject>(layout);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createComputePipelines(VkDevice, VkPipelineCache cache, std::uint32_t count,
+        const VkComputePipelineCreateInfo* infos, const VkAllocationCallbacks*, VkPipeline* pipelines) {
+        for (std::uint32_t i{}; i < count; ++i) {
+            if (cache != VK_NULL_HANDLE) {
+                auto* entries{ fromHandle<MockPipelineCache>(cache) };
+                const std::lock_guard<std::mutex> lock{ entries->mutex };
+                entries->hashes.insert(fromHandle<MockShaderModule>(infos[i].stage.module)->hash);
+            }
+            pipelines[i] = toHandle<VkPipeline>(new MockObject);
+        }
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyPipeline(VkDevice, VkPipeline pipeline, const VkAllocationCallbacks*) {
+        delete fromHandle<MockObject>(pipeline);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL createPipelineCache(VkDevice, const VkPipelineCacheCreateInfo* info,
+        const VkAllocationCallbacks*, VkPipelineCache* cache) {
+        auto* entries{ new MockPipelineCache };
+        // Data from another device or driver is ignored, as the specification allows.
+        VkPipelineCacheHeaderVersionOne header{};
+        if (info->initialDataSize >= sizeof(header)) {
+            const auto* data{ static_cast<const unsigned char*>(info->pInitialData) };
+            std::memcpy(&header, data, sizeof(header));
+            if (header.headerSize == sizeof(header) && header.vendorID == mockVendorId && header.deviceID == mockDeviceId
+                    && std::memcmp(header.pipelineCacheUUID, mockCacheUuid, VK_UUID_SIZE) == 0) {
+                for (std::size_t offset{ sizeof(header) }; offset + sizeof(std::uint64_t) <= info->initialDataSize; offset += sizeof(std::uint64_t)) {
+                    std::uint64_t hash{};
+                    std::memcpy(&hash, data + offset, sizeof(hash));
+                    entries->hashes.insert(hash);
+                }
+            }
+        }
+        *cache = toHandle<VkPipelineCache>(entries);
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL destroyPipelineCache(VkDevice, VkPipelineCache cache, const VkAllocationCallbacks*) {
+        delete fromHandle<MockPipelineCache>(cache);
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL getPipelineCacheData(VkDevice, VkPipelineCache cache, std::size_t* size, void* data) {
+        auto* entries{ fromHandle<MockPipelineCache>(cache) };
+        const std::lock_guard<std::mutex> lock{ entries->mutex };
+        VkPipelineCacheHeaderVersionOne header{};
+        header.headerSize = sizeof(header);
+        header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+        header.vendorID = mockVendorId;
+        header.deviceID = mockDeviceId;
+        std::memcpy(header.pipelineCacheUUID, mockCacheUuid, VK_UUID_SIZE);
+        const std::size_t needed{ sizeof(header) + entries->hashes.size() * sizeof(std::uint64_t) };
+        if (data == nullptr) {
+            *size = needed;
+            return VK_SUCCESS;
+        }
+        if (*size < needed) {
+            *size = 0;
+            return VK_INCOMPLETE;
+        }
+        auto* out{ static_cast<unsigned char*>(data) };
+        std::memcpy(out, &header, sizeof(header));
+        std::size_t offset{ sizeof(header) };
+        for (std::uint64_t hash : entries->hashes) {
+            std::memcpy(out + offset, &hash, sizeof(hash));
+            offset += sizeof(hash);
+        }
+        *size = needed;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL getInstanceProcAddr(VkInstance, const char* name);
+    VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL getDeviceProcAddr(VkDevice, const char* name);
+
+    struct Entry {
+        std::string_view name;
+        PFN_vkVoidFunction function;
+    };
+
+    const Entry entries[]{
+        { "vkCreateInstance", reinterpret_cast<PFN_vkVoidFunction>(createInstance) },
+        { "vkDestroyInstance", reinterpret_cast<PFN_vkVoidFunction>(destroyInstance) },
+        { "vkEnumerateInstanceExtensionProperties", reinterpret_cast<PFN_vkVoidFunction>(enumerateInstanceExtensionProperties) },
+        { "vkEnumerateInstanceVersion", reinterpret_cast<PFN_vkVoidFunction>(enumerateInstanceVersion) },
+        { "vkEnumeratePhysicalDevices", reinterpret_cast<PFN_vkVoidFunction>(enumeratePhysicalDevices) },
+        { "vkGetInstanceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(getInstanceProcAddr) },
+        { "vkEnumerateDeviceExtensionProperties", reinterpret_cast<PFN_vkVoidFunction>(enumerateDeviceExtensionProperties) },
+        { "vkGetPhysicalDeviceProperties", reinterpret_cast<PFN_vkVoidFunction>(getPhysicalDeviceProperties) },
+        { "vkGetPhysicalDeviceProperties2", reinterpret_cast<PFN_vkVoidFunction>(getPhysicalDeviceProperties2) },
+        { "vkGetPhysicalDeviceFeatures", reinterpret_cast<PFN_vkVoidFunction>(getPhysicalDeviceFeatures) },
+        { "vkGetPhysicalDeviceFeatures2", reinterpret_cast<PFN_vkVoidFunction>(getPhysicalDeviceFeatures2) },
+        { "vkGetPhysicalDeviceMemoryProperties", reinterpret_cast<PFN_vkVoidFunction>(getPhysicalDeviceMemoryProperties) },
+        { "vkGetPhysicalDeviceQueueFamilyProperties", reinterpret_cast<PFN_vkVoidFunction>(getPhysicalDeviceQueueFamilyProperties) },
+        { "vkGetPhysicalDeviceFormatProperties", reinterpret_cast<PFN_vkVoidFunction>(getPhysicalDeviceFormatProperties) },
+        { "vkGetPhysicalDeviceFormatProperties2", reinterpret_cast<PFN_vkVoidFunction>(getPhysicalDeviceFormatProperties2) },
+        { "vkCreateDevice", reinterpret_cast<PFN_vkVoidFunction>(createDevice) },
+        { "vkGetDeviceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(getDeviceProcAddr) },
+        { "vkDestroyDevice", reinterpret_cast<PFN_vkVoidFunction>(destroyDevice) },
+        { "vkGetDeviceQueue", reinterpret_cast<PFN_vkVoidFunction>(getDeviceQueue) },
+        { "vkDeviceWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(deviceWaitIdle) },
+        { "vkAllocateMemory", reinterpret_cast<PFN_vkVoidFunction>(allocateMemory) },
+        { "vkFreeMemory", reinterpret_cast<PFN_vkVoidFunction>(freeMemory) },
+        { "vkMapMemory", reinterpret_cast<PFN_vkVoidFunction>(mapMemory) },
+        { "vkUnmapMemory", reinterpret_cast<PFN_vkVoidFunction>(unmapMemory) },
+        { "vkFlushMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(syncMappedMemoryRanges) },
+        { "vkInvalidateMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(syncMappedMemoryRanges) },
+        { "vkCreateFence", reinterpret_cast<PFN_vkVoidFunction>(createFence) },
+        { "vkDestroyFence", reinterpret_cast<PFN_vkVoidFunction>(destroyFence) },
+        { "vkResetFences", reinterpret_cast<PFN_vkVoidFunction>(resetFences) },
+        { "vkWaitForFences", reinterpret_cast<PFN_vkVoidFunction>(waitForFences) },
+        { "vkQueueSubmit", reinterpret_cast<PFN_vkVoidFunction>(queueSubmit) },
+        { "vkCreateCommandPool", reinterpret_cast<PFN_vkVoidFunction>(createCommandPool) },
+        { "vkDestroyCommandPool", reinterpret_cast<PFN_vkVoidFunction>(destroyCommandPool) },
+        { "vkAllocateCommandBuffers", reinterpret_cast<PFN_vkVoidFunction>(allocateCommandBuffers) },
+        { "vkBeginCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(beginCommandBuffer) },
+        { "vkEndCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(endCommandBuffer) },
+        { "vkCmdBindPipeline", reinterpret_cast<PFN_vkVoidFunction>(cmdBindPipeline) },
+        { "vkCmdDispatch", reinterpret_cast<PFN_vkVoidFunction>(cmdDispatch) },
+        { "vkCmdResetQueryPool", reinterpret_cast<PFN_vkVoidFunction>(cmdResetQueryPool) },
+        { "vkCmdWriteTimestamp", reinterpret_cast<PFN_vkVoidFunction>(cmdWriteTimestamp) },
+        { "vkCreateQueryPool", reinterpret_cast<PFN_vkVoidFunction>(createQueryPool) },
+        { "vkDestroyQueryPool", reinterpret_cast<PFN_vkVoidFunction>(destroyQueryPool) },
+        { "vkGetQueryPoolResults", reinterpret_cast<PFN_vkVoidFunction>(getQueryPoolResults) },
+        { "vkCreateShaderModule", reinterpret_cast<PFN_vkVoidFunction>(createShaderModule) },
+        { "vkDestroyShaderModule", reinterpret_cast<PFN_vkVoidFunction>(destroyShaderModule) },
+        { "vkCreateDescriptorSetLayout", reinterpret_cast<PFN_vkVoidFunction>(createDescriptorSetLayout) },
+        { "vkDestroyDescriptorSetLayout", reinterpret_cast<PFN_vkVoidFunction>(destroyDescriptorSetLayout) },
+        { "vkCreatePipelineLayout", reinterpret_cast<PFN_vkVoidFunction>(createPipelineLayout) },
+        { "vkDestroyPipelineLayout", reinterpret_cast<PFN_vkVoidFunction>(destroyPipelineLayout) },
+        { "vkCreateComputePipelines", reinterpret_cast<PFN_vkVoidFunction>(createComputePipelines) },
+        { "vkDestroyPipeline", reinterpret_cast<PFN_vkVoidFunction>(destroyPipeline) },
+        { "vkCreatePipelineCache", reinterpret_cast<PFN_vkVoidFunction>(createPipelineCache) },
+        { "vkDestroyPipelineCache", reinterpret_cast<PFN_vkVoidFunction>(destroyPipelineCache) },
+        { "vkGetPipelineCacheData", reinterpret_cast<PFN_vkVoidFunction>(getPipelineCacheData) },
+    };
+
+    VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL getInstanceProcAddr(VkInstance, const char* name) {
+        for (const auto& entry : entries) {
+            if (entry.name == name) {
+                return entry.function;
+            }
+        }
+        return nullptr;
+    }
+
+    VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL getDeviceProcAddr(VkDevice, const char* name) {
+        return getInstanceProcAddr(VK_NULL_HANDLE, name);
+    }
+}
+
+SHW_MOCK_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vk_icdNegotiateLoaderICDInterfaceVersion(std::uint32_t* version) {
+    if (*version > loaderInterfaceVersion) {
+        *version = loaderInterfaceVersion;
+    }
+    return VK_SUCCESS;
+}
+
+SHW_MOCK_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vk_icdGetInstanceProcAddr(VkInstance instance, const char* name) {
+    return getInstanceProcAddr(instance, name);
+}
+
+SHW_MOCK_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vk_icdGetPhysicalDeviceProcAddr(VkInstance, const char*) {
+    return nullptr;
+}
@@ -0,0 +1,381 @@
+#include "baseline-vk.h"
+#include "cache-vk.h"
+#include "dispatch-vk.h"
+#include "index-vk.h"
+#include "instance-vk.h"
+#include "options-vk.h"
+#include "query-vk.h"
+#include "snapshot-vk.h"
+#include "table-vk.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Benchmarks every stage of show-vk in isolation and prints one JSON object
+// per benchmark and line. By default the loader is pointed at the bundled
+// mock ICD and a set of generated layer manifests, so the numbers depend on
+// the requested counts rather than on the drivers of the machine. Without a
+// system loader (GPU-less CI) the mock ICD is opened directly instead, which
+// leaves out the layers and the loader's share of the work.
+//
+//   show-vk-bench [--extensions=N] [--layers=N] [--layer-extensions=N]
+//                 [--iterations=N] [--filter=TEXT] [--icd=PATH] [--system]
+namespace {
+    struct BenchConfig {
+        std::uint32_t extensions{ 10000 };
+        std::uint32_t layers{ 16 };
+        std::uint32_t layerExtensions{ 64 };
+        std::uint32_t iterations{ 20 };
+        // Only benchmarks whose name contains this run.
+        std::string_view filter;
+        std::string_view icd{ SHOW_VK_BENCH_MOCK_ICD };
+        // Measure the loader environment of the machine instead of the mock.
+        bool system{};
+        // No system loader: the mock ICD is opened directly, without layers.
+        bool direct{};
+    };
+
+    struct CountSetting {
+        std::string_view name;
+        std::uint32_t BenchConfig::*member;
+    };
+
+    constexpr CountSetting countSettings[]{
+        { "--extensions", &BenchConfig::extensions },
+        { "--layers", &BenchConfig::layers },
+        { "--layer-extensions", &BenchConfig::layerExtensions },
+        { "--iterations", &BenchConfig::iterations },
+    };
+
+    BenchConfig parseBenchArgs(int argc, const char* const* argv) {
+        BenchConfig config;
+        for (int i{ 1 }; i < argc; ++i) {
+            const std::string_view arg{ argv[i] };
+            const std::size_t delim{ arg.find('=') };
+            const std::string_view name{ arg.substr(0, delim) };
+            const std::string_view value{ delim != std::string_view::npos ? arg.substr(delim + 1) : std::string_view{} };
+            const auto setting{ std::find_if(std::begin(countSettings), std::end(countSettings),
+                [&](const CountSetting& setting) { return setting.name == name; }) };
+            if (setting != std::end(countSettings) && !value.empty()) {
+                config.*setting->member = static_cast<std::uint32_t>(std::strtoul(std::string{ value }.c_str(), nullptr, 10));
+            }
+            else if (name == "--filter") {
+                config.filter = value;
+            }
+            else if (name == "--icd" && !value.empty()) {
+                config.icd = value;
+            }
+            else if (arg == "--system") {
+                config.system = true;
+            }
+            else {
+                throw std::runtime_error{ "Unknown argument: " + std::string{ arg } };
+            }
+        }
+        config.iterations = std::max(config.iterations, 1u);
+        if (!config.system && !shw::hasSystemVulkanLoader()) {
+            std::fprintf(stderr, "No Vulkan loader found; opening the mock ICD directly, without layers.\n");
+            config.direct = true;
+            config.layers = 0;
+        }
+        return config;
+    }
+
+    void setEnvironment(const char* name, const std::string& value) {
+#if defined(_WIN32)
+        _putenv_s(name, value.c_str());
+#else
+        setenv(name, value.c_str(), 1);
+#endif
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content) {
+        std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!out) {
+            throw std::runtime_error{ "Cannot write " + path.string() };
+        }
+    }
+
+    std::string mockLayerName(std::uint32_t layer) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "VK_LAYER_MOCK_%04u", layer);
+        return name;
+    }
+
+    // Writes an ICD manifest for the mock driver and one explicit layer
+    // manifest per synthetic layer into a temporary directory, then points the
+    // loader at them. The loader reads layer names and extensions from the
+    // manifests, so the layer libraries are never loaded.
+    class MockEnvironment {
+    public:
+        explicit MockEnvironment(const BenchConfig& config) {
+            setEnvironment("SHOW_VK_MOCK_EXTENSIONS", std::to_string(config.extensions));
+            if (config.direct) {
+                shw::setVulkanLibrary(config.icd);
+                return;
+            }
+            directory_ = std::filesystem::temp_directory_path()
+                / ("show-vk-bench-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+            const std::filesystem::path layerDirectory{ directory_ / "layers" };
+            std::filesystem::create_directories(layerDirectory);
+            // Manifests are JSON, and forward slashes need no escaping there.
+            const std::string library{ std::filesystem::absolute(std::filesystem::path{ config.icd }).generic_string() };
+
+            const std::filesystem::path icdManifest{ directory_ / "mock-icd.json" };
+            writeFile(icdManifest, "{ \"file_format_version\": \"1.0.0\", \"ICD\": { \"library_path\": \""
+                + library + "\", \"api_version\": \"1.3.0\" } }\n");
+
+            std::string manifest;
+            for (std::uint32_t layer{}; layer < config.layers; ++layer) {
+                manifest = "{ \"file_format_version\": \"1.0.0\", \"layer\": { \"name\": \"" + mockLayerName(layer)
+                    + "\", \"type\": \"GLOBAL\", \"library_path\": \"" + library
+                    + "\", \"api_version\": \"1.3.0\", \"implementation_version\": \"1\","
+                    " \"description\": \"show-vk-bench synthetic layer\", \"instance_extensions\": [";
+                for (std::uint32_t extension{}; extension < config.layerExtensions; ++extension) {
+                    char name[64];
+                    std::snprintf(name, sizeof(name), "VK_MOCK_layer_%04u_extension_%04u", layer, extension);
+                    manifest += extension == 0 ? " " : ", ";
+                    manifest += "{ \"name\": \"";
+                    manifest += name;
+                    manifest += "\", \"spec_version\": \"1\" }";
+                }
+                manifest += " ] } }\n";
+                writeFile(layerDirectory / (mockLayerName(layer) + ".json"), manifest);
+            }
+
+            const std::string icdPath{ icdManifest.generic_string() };
+            setEnvironment("VK_DRIVER_FILES", icdPath);
+            setEnvironment("VK_ICD_FILENAMES", icdPath);
+            setEnvironment("VK_LAYER_PATH", layerDirectory.generic_string());
+            // Implicit layers installed on the machine would skew the counts.
+            setEnvironment("VK_LOADER_LAYERS_DISABLE", "~implicit~");
+        }
+
+        MockEnvironment(const MockEnvironment&) = delete;
+        MockEnvironment& operator=(const MockEnvironment&) = delete;
+
+        ~MockEnvironment() {
+            if (!directory_.empty()) {
+                std::error_code error;
+                std::filesystem::remove_all(directory_, error);
+            }
+        }
+
+    private:
+        std::filesystem::path directory_;
+    };
+
+    class BenchRunner {
+    public:
+        explicit BenchRunner(const BenchConfig& config) : config_{ config } {
+            samples_.reserve(config.iterations);
+        }
+
+        // Runs body once to warm up, then config.iterations times, and prints
+        // the distribution of the timed runs. items is the amount of work one
+        // run does (names enumerated, looked up or rendered).
+        template<typename Body>
+        void run(std::string_view name, std::size_t items, Body&& body) {
+            if (!config_.filter.empty() && name.find(config_.filter) == std::string_view::npos) {
+                return;
+            }
+            body();
+            samples_.clear();
+            for (std::uint32_t i{}; i < config_.iterations; ++i) {
+                const auto start{ std::chrono::steady_clock::now() };
+                body();
+                const auto stop{ std::chrono::steady_clock::now() };
+                samples_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+            }
+            report(name, items);
+        }
+
+    private:
+        void report(std::string_view name, std::size_t items) {
+            std::sort(samples_.begin(), samples_.end());
+            long long total{};
+            for (const auto sample : samples_) {
+                total += sample;
+            }
+            const std::size_t count{ samples_.size() };
+            std::printf("{\"bench\":\"%.*s\",\"mock\":%s,\"loader\":%s,\"extensions\":%u,\"layers\":%u,\"layerExtensions\":%u,"
+                "\"items\":%zu,\"iterations\":%zu,\"minNs\":%lld,\"medianNs\":%lld,\"p90Ns\":%lld,\"maxNs\":%lld,\"meanNs\":%lld}\n",
+                static_cast<int>(name.size()), name.data(), config_.system ? "false" : "true", config_.direct ? "false" : "true",
+                config_.extensions, config_.layers, config_.layerExtensions, items, count,
+                samples_.front(), samples_[count / 2], samples_[count * 9 / 10], samples_.back(),
+                total / static_cast<long long>(count));
+            std::fflush(stdout);
+        }
+
+        const BenchConfig& config_;
+        std::vector<long long> samples_;
+    };
+
+    struct Format {
+        shw::OutputFormat format;
+        std::string_view name;
+    };
+
+    constexpr Format formats[]{
+        { shw::OutputFormat::Text, "text" },
+        { shw::OutputFormat::Json, "json" },
+        { shw::OutputFormat::Cbor, "cbor" },
+    };
+
+    std::string joinNames(const std::vector<std::string>& names) {
+        std::string list;
+        for (const auto& name : names) {
+            list += list.empty() ? "" : ",";
+            list += name;
+        }
+        return list;
+    }
+
+    std::vector<const char*> namePointers(const std::vector<std::string>& names) {
+        std::vector<const char*> pointers;
+        pointers.reserve(names.size());
+        for (const auto& name : names) {
+            pointers.push_back(name.c_str());
+        }
+        return pointers;
+    }
+
+    void runBenchmarks(const BenchConfig& config) {
+        BenchRunner bench{ config };
+
+        // enumeration
+        std::vector<VkExtensionProperties> extensions;
+        std::vector<VkLayerProperties> layers;
+        bench.run("enumerate.instanceExtensions", config.extensions, [&] { shw::getInstanceExtensions(nullptr, extensions); });
+        bench.run("enumerate.instanceLayers", config.layers, [&] { shw::getInstanceLayers(layers); });
+        shw::getInstanceLayers(layers);
+        bench.run("enumerate.layerExtensions", layers.size() * config.layerExtensions, [&] {
+            for (const auto& layer : layers) {
+                shw::getInstanceExtensions(layer.layerName, extensions);
+            }
+        });
+
+        // snapshot and cache format
+        shw::InstanceSnapshot snapshot;
+        shw::takeInstanceSnapshot(snapshot);
+        std::size_t layerExtensionCount{};
+        for (const auto& layerExtensions : snapshot.layerExtensions) {
+            layerExtensionCount += layerExtensions.size();
+        }
+        const std::size_t extensionCount{ snapshot.extensions.size() + layerExtensionCount };
+        bench.run("snapshot.take", extensionCount, [&] { shw::takeInstanceSnapshot(snapshot); });
+        bench.run("snapshot.fingerprint", 1, [] { shw::loaderFingerprint(); });
+        std::string blob;
+        std::uint64_t fingerprint{ shw::loaderFingerprint() };
+        bench.run("snapshot.serialize", extensionCount, [&] {
+            blob.clear();
+            shw::serializeSnapshot(snapshot, fingerprint, blob);
+        });
+        shw::InstanceSnapshot restored;
+        bench.run("snapshot.deserialize", extensionCount, [&] {
+            if (!shw::deserializeSnapshot(blob.data(), blob.size(), fingerprint, restored)) {
+                throw std::runtime_error{ "Serialized snapshot did not read back" };
+            }
+        });
+
+        // Queries: every extension by exact name, by prefix and scoped to its layer.
+        std::vector<std::string> exactNames, prefixNames, layerScopedNames, layerNames;
+        for (const auto& extension : snapshot.extensions) {
+            exactNames.emplace_back(extension.extensionName);
+        }
+        for (std::size_t i{}, length{ snapshot.layers.size() }; i < length; ++i) {
+            const std::string layerName{ snapshot.layers[i].layerName };
+            layerNames.push_back(layerName);
+            for (const auto& extension : snapshot.layerExtensions[i]) {
+                exactNames.emplace_back(extension.extensionName);
+                layerScopedNames.push_back(layerName + ':' + extension.extensionName);
+            }
+        }
+        for (const auto& name : exactNames) {
+            prefixNames.push_back(name.substr(0, name.size() > 2 ? name.size() - 2 : 0) + '*');
+        }
+
+        // argument parsing
+        const std::string extensionList{ "--instance-support-extensions=" + joinNames(exactNames) };
+        const std::string layerList{ "--instance-support-layers=" + joinNames(layerNames) };
+        const char* const argv[]{ "show-vk", "--instance-all", "--format=json", extensionList.c_str(), layerList.c_str() };
+        bench.run("options.parse", exactNames.size() + layerNames.size(), [&] {
+            shw::Options options;
+            shw::parseOptions(static_cast<int>(std::size(argv)), argv, options);
+        });
+
+        // support lookups
+        shw::NameIndex index{ snapshot };
+        bench.run("index.build", extensionCount + snapshot.layers.size(), [&] { index.rebuild(snapshot); });
+        std::vector<VkBool32> supported;
+        const auto lookup{ [&](std::string_view name, const std::vector<std::string>& names, bool layerQuery) {
+            const std::vector<const char*> pointers{ namePointers(names) };
+            supported.resize(names.size());
+            bench.run(name, names.size(), [&] {
+                const auto count{ static_cast<std::uint32_t>(pointers.size()) };
+                if (layerQuery) {
+                    shw::queryInstanceLayersSupport(index, pointers.data(), count, supported.data());
+                }
+                else {
+                    shw::queryInstanceExtensionsSupport(index, pointers.data(), count, supported.data());
+                }
+            });
+        } };
+        lookup("lookup.exact", exactNames, false);
+        lookup("lookup.prefix", prefixNames, false);
+        lookup("lookup.layerScoped", layerScopedNames, false);
+        lookup("lookup.layers", layerNames, true);
+
+        // Rendering goes through the global output buffer with its sink
+        // detached, so sections are built and flushed but never written.
+        const std::vector<std::string_view> extensionQueries{ exactNames.cbegin(), exactNames.cend() };
+        shw::OutputBuffer& out{ shw::output() };
+        out.setSink(nullptr);
+        for (const auto& format : formats) {
+            const auto render{ [&](std::string_view table, std::size_t rows, auto&& print) {
+                out.setFormat(format.format);
+                bench.run(std::string{ "render." }.append(table).append(".").append(format.name), rows, [&] {
+                    out.clear();
+                    shw::beginDocument(out);
+                    print();
+                    shw::endDocument(out);
+                });
+                out.clear();
+            } };
+            render("instanceExtensions", snapshot.extensions.size(), [&] { shw::printInstanceExtensions(snapshot); });
+            render("instanceLayers", snapshot.layers.size(), [&] { shw::printInstanceLayers(snapshot); });
+            render("instanceExtensionsSupport", extensionQueries.size(),
+                [&] { shw::printInstanceExtensionsSupport(index, extensionQueries); });
+        }
+        out.setFormat(shw::OutputFormat::Text);
+        out.setSink(stdout);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Caught so that MockEnvironment still removes its temporary manifests.
+    try {
+        const BenchConfig config{ parseBenchArgs(argc, argv) };
+        if (config.system) {
+            runBenchmarks(config);
+        }
+        else {
+            const MockEnvironment environment{ config };
+            runBenchmarks(config);
+        }
+        return 0;
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return shw::errorExitCode;
+    }
+}
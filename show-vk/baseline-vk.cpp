@@ -0,0 +1,133 @@
+#include "baseline-vk.h"
+#include "options-vk.h"
+#include "probe-vk.h"
+#include "table-vk.h"
+#include "trace-vk.h"
+
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+    struct DriftRow {
+        shw::ProbeChange change;
+        const shw::ProbeEntry* before;
+        const shw::ProbeEntry* after;
+
+        const shw::ProbeEntry& entry() const { return before != nullptr ? *before : *after; }
+    };
+
+    shw::Cell valueCell(const shw::ProbeEntry* entry) {
+        return shw::Cell::str(entry != nullptr ? std::string_view{ entry->value } : shw::absentValue);
+    }
+
+    constexpr shw::Column<DriftRow> driftColumns[]{
+        { "change", "Change", shw::Align::Left, [](const DriftRow& row) { return shw::Cell::str(shw::probeChangeToStr(row.change)); } },
+        { "section", "Section", shw::Align::Left, [](const DriftRow& row) { return shw::Cell::str(shw::probeSectionToStr(row.entry().section)); } },
+        { "name", "Name", shw::Align::Left, [](const DriftRow& row) { return shw::Cell::str(row.entry().name); } },
+        { "baseline", "Baseline", shw::Align::Left, [](const DriftRow& row) { return valueCell(row.before); } },
+        { "current", "Current", shw::Align::Left, [](const DriftRow& row) { return valueCell(row.after); } },
+    };
+
+    void printProbeErrors(std::string_view key, std::string_view label, const shw::ProbeResult& probe) {
+        const std::string& error{ !probe.instanceError.empty() ? probe.instanceError : probe.deviceError };
+        if (!error.empty()) {
+            shw::OutputBuffer& out{ shw::output() };
+            shw::writeField(out, key, label, shw::Cell::str(error));
+            shw::endSection(out);
+        }
+    }
+}
+
+bool shw::loadBaseline(const std::string& path, std::string& data, ProbeResult& probe) {
+    std::ifstream in{ path, std::ios::binary };
+    if (!in) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{});
+    return !in.bad() && deserializeProbe(data.data(), data.size(), probe);
+}
+
+void shw::storeBaseline(const std::string& path, const std::string& data) {
+    std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+    if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+        throw std::runtime_error{ "Cannot write baseline file: " + path };
+    }
+}
+
+int shw::executeBaselineOptions(const Options& options) {
+    const bool compare{ options.isSet(Option::Baseline) };
+    if (!compare && !options.isSet(Option::BaselineSave)) {
+        return 0;
+    }
+    const bool quiet{ options.isSet(Option::BaselineQuiet) };
+    // Each emplace() ends the previous trace section and starts the next.
+    std::optional<TraceScope> scope;
+    ProbeResult baseline;
+    std::string baselineData;
+    if (compare) {
+        scope.emplace("loadBaseline");
+        const std::string path{ options.value(Option::Baseline) };
+        if (!loadBaseline(path, baselineData, baseline)) {
+            throw std::runtime_error{ "Cannot read baseline file: " + path };
+        }
+    }
+    scope.reset();
+    const ProbeResult current{ probeCapabilities() };
+    std::string currentData;
+    if (options.isSet(Option::BaselineSave) || quiet) {
+        scope.emplace("serializeProbe");
+        serializeProbe(current, currentData);
+    }
+    if (options.isSet(Option::BaselineSave)) {
+        scope.emplace("storeBaseline");
+        storeBaseline(std::string{ options.value(Option::BaselineSave) }, currentData);
+    }
+    if (!compare) {
+        return 0;
+    }
+
+    // A failed probe flattens to nothing, which would read as every entry
+    // having been added or removed.
+    if (baseline.failed() || current.failed()) {
+        if (!quiet) {
+            scope.emplace("printBaseline");
+            printProbeErrors("baselineError", "Baseline probe failed: ", baseline);
+            printProbeErrors("currentError", "Current probe failed: ", current);
+        }
+        return errorExitCode;
+    }
+
+    scope.emplace("compareBaseline");
+    // Only the answer matters here. An unchanged system serializes to the
+    // same bytes, which settles it without flattening either side.
+    if (quiet && currentData == baselineData) {
+        return 0;
+    }
+    const std::vector<ProbeEntry> before{ flattenProbe(baseline) };
+    const std::vector<ProbeEntry> after{ flattenProbe(current) };
+    // Enumeration order can differ between runs, so compare the sorted
+    // entries, stopping at the first change.
+    if (quiet) {
+        const std::size_t changes{ compareProbeEntries(before, after,
+            [](ProbeChange, const ProbeEntry*, const ProbeEntry*) { return false; }) };
+        return changes > 0 ? driftExitCode : 0;
+    }
+    std::vector<DriftRow> rows;
+    compareProbeEntries(before, after, [&](ProbeChange change, const ProbeEntry* from, const ProbeEntry* to) {
+        rows.push_back({ change, from, to });
+        return true;
+    });
+
+    scope.emplace("printBaseline");
+    OutputBuffer& out{ output() };
+    if (!rows.empty() || out.format() != OutputFormat::Text) {
+        renderTable(out, "baselineChanges", "Changes since the baseline:\n", driftColumns, rows);
+    }
+    writeField(out, "baselineChangeCount", "Total changes: ", Cell::number(rows.size()));
+    endSection(out);
+    return rows.empty() ? 0 : driftExitCode;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+namespace shw {
+    class Options;
+    struct ProbeResult;
+
+    // Exit codes: 0 when nothing changed or no --baseline/--configs check ran,
+    // driftExitCode when a check found changes and errorExitCode when the
+    // run stopped on an error, including a failed probe on either side of the
+    // baseline comparison, which would otherwise look like everything changed,
+    // and a --configs configuration that could not be probed.
+    inline constexpr int driftExitCode{ 1 };
+    inline constexpr int errorExitCode{ 2 };
+
+    // A baseline file holds one serializeProbe() record; data receives or
+    // holds those raw bytes.
+    bool loadBaseline(const std::string& path, std::string& data, ProbeResult& probe);
+    void storeBaseline(const std::string& path, const std::string& data);
+
+    // --baseline / --baseline-save: compares the live instance and device
+    // enumeration against a saved one and prints only what was added, removed
+    // or changed. Returns driftExitCode when anything changed, errorExitCode
+    // when either probe failed and 0 otherwise. --baseline-quiet prints nothing
+    // of its own and stops at the first change; other sections still print.
+    int executeBaselineOptions(const Options& options);
+}
@@ -0,0 +1,68 @@
+#include "bench-vk.h"
+#include "error-vk.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+std::uint64_t shw::benchClock() {
+    const auto now{ std::chrono::steady_clock::now().time_since_epoch() };
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+shw::BenchStats shw::summarize(std::vector<std::uint64_t>& samples) {
+    BenchStats stats;
+    stats.samples = samples.size();
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile{ [&](std::size_t percent) { return samples[(samples.size() - 1) * percent / 100]; } };
+    stats.min = samples.front();
+    stats.p50 = percentile(50);
+    stats.p90 = percentile(90);
+    stats.p99 = percentile(99);
+    stats.max = samples.back();
+    return stats;
+}
+
+shw::BenchDevice::BenchDevice(VkPhysicalDevice physicalDevice, const std::vector<std::uint32_t>& queueFamilies)
+    : families_{ queueFamilies } {
+    constexpr float priority{ 1.0f };
+    std::vector<VkDeviceQueueCreateInfo> queueInfos;
+    queueInfos.reserve(families_.size());
+    for (std::uint32_t family : families_) {
+        VkDeviceQueueCreateInfo queueInfo{};
+        queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfo.queueFamilyIndex = family;
+        queueInfo.queueCount = 1;
+        queueInfo.pQueuePriorities = &priority;
+        queueInfos.push_back(queueInfo);
+    }
+    VkDeviceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.queueCreateInfoCount = static_cast<std::uint32_t>(queueInfos.size());
+    createInfo.pQueueCreateInfos = queueInfos.data();
+    const VkResult result{ SHW_VK_CALL(vkCreateDevice, physicalDevice, &createInfo, nullptr, &device_) };
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error{ getError("vkCreateDevice() failed", result) };
+    }
+    loadDeviceFunctions(device_, functions_);
+    queues_.resize(families_.size());
+    for (std::size_t i{}, length{ families_.size() }; i < length; ++i) {
+        SHW_VK_DEVICE_CALL(functions_, vkGetDeviceQueue, device_, families_[i], 0, &queues_[i]);
+    }
+}
+
+shw::BenchDevice::~BenchDevice() {
+    // Also reached while unwinding from a failed submit or wait, when work
+    // may still be pending. The result is ignored; there is no way to report
+    // it from here.
+    SHW_VK_DEVICE_CALL(functions_, vkDeviceWaitIdle, device_);
+    SHW_VK_DEVICE_CALL(functions_, vkDestroyDevice, device_, nullptr);
+}
+
+VkQueue shw::BenchDevice::queue(std::uint32_t family) const {
+    const auto it{ std::find(families_.cbegin(), families_.cend(), family) };
+    return it != families_.cend() ? queues_[static_cast<std::size_t>(it - families_.cbegin())] : VkQueue{};
+}
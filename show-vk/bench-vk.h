@@ -0,0 +1,53 @@
+#pragma once
+
+#include "dispatch-vk.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace shw {
+    // Nanoseconds from a monotonic clock, for timing benchmark iterations.
+    std::uint64_t benchClock();
+
+    // Distribution of a set of timings in nanoseconds.
+    struct BenchStats {
+        std::size_t samples{};
+        std::uint64_t min{};
+        std::uint64_t p50{};
+        std::uint64_t p90{};
+        std::uint64_t p99{};
+        std::uint64_t max{};
+    };
+
+    // Sorts samples in place.
+    BenchStats summarize(std::vector<std::uint64_t>& samples);
+
+    // Bytes per nanosecond is GB/s.
+    inline double gigabytesPerSecond(std::uint64_t bytes, std::uint64_t nanoseconds) {
+        return nanoseconds > 0 ? static_cast<double>(bytes) / static_cast<double>(nanoseconds) : 0.0;
+    }
+
+    // A logical device created only to run benchmarks on, with the first
+    // queue of each requested family and its own function table.
+    class BenchDevice {
+    public:
+        BenchDevice(VkPhysicalDevice physicalDevice, const std::vector<std::uint32_t>& queueFamilies);
+        ~BenchDevice();
+
+        BenchDevice(const BenchDevice&) = delete;
+        BenchDevice& operator=(const BenchDevice&) = delete;
+
+        VkDevice get() const { return device_; }
+        const DeviceFunctions& functions() const { return functions_; }
+        // family must be one of the requested queue families.
+        VkQueue queue(std::uint32_t family) const;
+
+    private:
+        VkDevice device_{};
+        DeviceFunctions functions_;
+        std::vector<std::uint32_t> families_;
+        std::vector<VkQueue> queues_;
+    };
+}
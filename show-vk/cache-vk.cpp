@@ -0,0 +1,489 @@
+#include "cache-vk.h"
+#include "dispatch-vk.h"
+#include "snapshot-vk.h"
+#include "trace-vk.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char snapshotMagic[8]{ 'S', 'H', 'W', 'V', 'K', 'S', 'N', 'P' };
+    constexpr std::uint32_t snapshotFormatVersion{ 1 };
+
+    struct SnapshotHeader {
+        char magic[8];
+        std::uint32_t formatVersion;
+        std::uint32_t extensionSize;
+        std::uint32_t layerSize;
+        std::int32_t versionResult;
+        std::uint64_t fingerprint;
+        std::uint32_t version;
+        std::uint32_t extensionCount;
+        std::uint32_t layerCount;
+        std::uint32_t layerExtensionCount;
+    };
+    static_assert(sizeof(SnapshotHeader) % alignof(std::uint64_t) == 0, "SnapshotHeader must keep the arrays aligned");
+
+    // Variables the loader consults while building its driver and layer lists.
+    constexpr std::array<const char*, 16> loaderEnvironment{
+        "VK_ICD_FILENAMES", "VK_DRIVER_FILES", "VK_ADD_DRIVER_FILES",
+        "VK_LAYER_PATH", "VK_ADD_LAYER_PATH", "VK_IMPLICIT_LAYER_PATH", "VK_ADD_IMPLICIT_LAYER_PATH",
+        "VK_INSTANCE_LAYERS", "VK_LOADER_LAYERS_ENABLE", "VK_LOADER_LAYERS_DISABLE",
+        "VK_LOADER_DRIVERS_SELECT", "VK_LOADER_DRIVERS_DISABLE",
+        "XDG_CONFIG_HOME", "XDG_CONFIG_DIRS", "XDG_DATA_HOME", "XDG_DATA_DIRS"
+    };
+
+    // The subset of loaderEnvironment that lists manifest files or directories.
+    constexpr std::array<const char*, 7> manifestPathEnvironment{
+        "VK_ICD_FILENAMES", "VK_DRIVER_FILES", "VK_ADD_DRIVER_FILES",
+        "VK_LAYER_PATH", "VK_ADD_LAYER_PATH", "VK_IMPLICIT_LAYER_PATH", "VK_ADD_IMPLICIT_LAYER_PATH"
+    };
+
+    constexpr std::array<const char*, 3> manifestDirs{
+        "vulkan/icd.d", "vulkan/implicit_layer.d", "vulkan/explicit_layer.d"
+    };
+
+#ifdef _WIN32
+    constexpr char pathListDelim{ ';' };
+#else
+    constexpr char pathListDelim{ ':' };
+#endif
+
+    constexpr std::uint64_t fnvOffsetBasis{ 14695981039346656037ull };
+    constexpr std::uint64_t fnvPrime{ 1099511628211ull };
+
+    void hashBytes(std::uint64_t& hash, const void* data, std::size_t size) {
+        const auto* bytes{ static_cast<const unsigned char*>(data) };
+        for (std::size_t i{}; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= fnvPrime;
+        }
+    }
+
+    template<typename T>
+    void hashValue(std::uint64_t& hash, const T& value) {
+        hashBytes(hash, &value, sizeof(value));
+    }
+
+    void hashString(std::uint64_t& hash, const std::string& value) {
+        hashBytes(hash, value.data(), value.size() + 1);
+    }
+
+    std::string getEnv(const char* name) {
+        const char* value{ std::getenv(name) };
+        return value != nullptr ? value : "";
+    }
+
+    std::vector<std::string> splitPathList(const std::string& list) {
+        std::vector<std::string> paths;
+        std::size_t begin{};
+        while (begin <= list.size()) {
+            std::size_t end{ list.find(pathListDelim, begin) };
+            if (end == std::string::npos) {
+                end = list.size();
+            }
+            if (end > begin) {
+                paths.push_back(list.substr(begin, end - begin));
+            }
+            begin = end + 1;
+        }
+        return paths;
+    }
+
+    void hashManifest(std::uint64_t& hash, const fs::path& path) {
+        std::error_code error;
+        hashString(hash, path.string());
+        const std::uintmax_t size{ fs::file_size(path, error) };
+        hashValue(hash, error ? std::uintmax_t{} : size);
+        const fs::file_time_type time{ fs::last_write_time(path, error) };
+        hashValue(hash, error ? fs::file_time_type::rep{} : time.time_since_epoch().count());
+    }
+
+    // Hashes a manifest file, or every manifest in a directory in a stable order
+    // so that adding or removing one changes the fingerprint too.
+    void hashManifestPath(std::uint64_t& hash, const fs::path& path) {
+        std::error_code error;
+        if (!fs::is_directory(path, error)) {
+            hashManifest(hash, path);
+            return;
+        }
+        std::vector<fs::path> manifests;
+        for (const auto& entry : fs::directory_iterator{ path, error }) {
+            if (entry.path().extension() == ".json") {
+                manifests.push_back(entry.path());
+            }
+        }
+        std::sort(manifests.begin(), manifests.end());
+        hashString(hash, path.string());
+        hashValue(hash, manifests.size());
+        for (const auto& manifest : manifests) {
+            hashManifest(hash, manifest);
+        }
+    }
+
+#ifdef _WIN32
+    // Windows registers manifests as value names under the Khronos keys.
+    void hashRegistryManifests(std::uint64_t& hash, HKEY root, const char* subKey) {
+        HKEY key{};
+        if (RegOpenKeyExA(root, subKey, 0, KEY_READ, &key) != ERROR_SUCCESS) {
+            return;
+        }
+        char name[MAX_PATH];
+        for (DWORD i{};; ++i) {
+            DWORD nameSize{ MAX_PATH };
+            if (RegEnumValueA(key, i, name, &nameSize, nullptr, nullptr, nullptr, nullptr) != ERROR_SUCCESS) {
+                break;
+            }
+            hashManifest(hash, fs::path{ std::string{ name, nameSize } });
+        }
+        RegCloseKey(key);
+    }
+#else
+    std::vector<fs::path> manifestSearchRoots() {
+        const std::string home{ getEnv("HOME") };
+        std::string configHome{ getEnv("XDG_CONFIG_HOME") };
+        std::string configDirs{ getEnv("XDG_CONFIG_DIRS") };
+        std::string dataHome{ getEnv("XDG_DATA_HOME") };
+        std::string dataDirs{ getEnv("XDG_DATA_DIRS") };
+        if (configHome.empty() && !home.empty()) {
+            configHome = home + "/.config";
+        }
+        if (configDirs.empty()) {
+            configDirs = "/etc/xdg";
+        }
+        if (dataHome.empty() && !home.empty()) {
+            dataHome = home + "/.local/share";
+        }
+        if (dataDirs.empty()) {
+            dataDirs = "/usr/local/share:/usr/share";
+        }
+        std::vector<fs::path> roots;
+        if (!configHome.empty()) {
+            roots.emplace_back(configHome);
+        }
+        for (const auto& dir : splitPathList(configDirs)) {
+            roots.emplace_back(dir);
+        }
+        roots.emplace_back("/etc");
+        if (!dataHome.empty()) {
+            roots.emplace_back(dataHome);
+        }
+        for (const auto& dir : splitPathList(dataDirs)) {
+            roots.emplace_back(dir);
+        }
+        return roots;
+    }
+#endif
+
+    class MappedFile {
+    public:
+        explicit MappedFile(const fs::path& path) {
+#ifdef _WIN32
+            file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE) {
+                return;
+            }
+            LARGE_INTEGER fileSize{};
+            if (!GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0) {
+                return;
+            }
+            mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_ == nullptr) {
+                return;
+            }
+            data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+            if (data_ != nullptr) {
+                size_ = static_cast<std::size_t>(fileSize.QuadPart);
+            }
+#else
+            const int fd{ open(path.c_str(), O_RDONLY | O_CLOEXEC) };
+            if (fd < 0) {
+                return;
+            }
+            struct stat info{};
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                void* data{ mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0) };
+                if (data != MAP_FAILED) {
+                    data_ = data;
+                    size_ = static_cast<std::size_t>(info.st_size);
+                }
+            }
+            close(fd);
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (data_ != nullptr) {
+                UnmapViewOfFile(data_);
+            }
+            if (mapping_ != nullptr) {
+                CloseHandle(mapping_);
+            }
+            if (file_ != INVALID_HANDLE_VALUE) {
+                CloseHandle(file_);
+            }
+#else
+            if (data_ != nullptr) {
+                munmap(const_cast<void*>(data_), size_);
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const void* data() const { return data_; }
+        std::size_t size() const { return size_; }
+
+    private:
+        const void* data_{};
+        std::size_t size_{};
+#ifdef _WIN32
+        HANDLE file_{ INVALID_HANDLE_VALUE };
+        HANDLE mapping_{};
+#endif
+    };
+
+    bool readHeader(const void* data, std::size_t size, SnapshotHeader& header) {
+        if (data == nullptr || size < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        return std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) == 0
+            && header.formatVersion == snapshotFormatVersion
+            && header.extensionSize == sizeof(VkExtensionProperties)
+            && header.layerSize == sizeof(VkLayerProperties);
+    }
+
+    template<typename T>
+    void appendArray(std::string& out, const T* data, std::size_t count) {
+        out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+    }
+
+    template<typename T>
+    const unsigned char* readArray(const unsigned char* in, std::vector<T>& out, std::size_t count) {
+        out.resize(count);
+        if (count > 0) {
+            std::memcpy(out.data(), in, count * sizeof(T));
+        }
+        return in + count * sizeof(T);
+    }
+}
+
+std::uint64_t shw::loaderFingerprint() {
+    std::uint64_t hash{ fnvOffsetBasis };
+    for (const char* name : loaderEnvironment) {
+        hashString(hash, getEnv(name));
+    }
+    // The library actually opened, the default loader included: a loader
+    // upgrade changes the API version and the loader-provided extensions
+    // without touching any manifest.
+    hashManifest(hash, loadedVulkanLibrary());
+    for (const char* name : manifestPathEnvironment) {
+        for (const auto& path : splitPathList(getEnv(name))) {
+            hashManifestPath(hash, path);
+        }
+    }
+#ifdef _WIN32
+    for (HKEY root : { HKEY_LOCAL_MACHINE, HKEY_CURRENT_USER }) {
+        hashRegistryManifests(hash, root, "SOFTWARE\\Khronos\\Vulkan\\Drivers");
+        hashRegistryManifests(hash, root, "SOFTWARE\\Khronos\\Vulkan\\ImplicitLayers");
+        hashRegistryManifests(hash, root, "SOFTWARE\\Khronos\\Vulkan\\ExplicitLayers");
+    }
+#else
+    for (const auto& root : manifestSearchRoots()) {
+        for (const char* dir : manifestDirs) {
+            hashManifestPath(hash, root / dir);
+        }
+    }
+#endif
+    return hash;
+}
+
+void shw::serializeSnapshot(const InstanceSnapshot& snapshot, std::uint64_t fingerprint, std::string& out) {
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.formatVersion = snapshotFormatVersion;
+    header.extensionSize = sizeof(VkExtensionProperties);
+    header.layerSize = sizeof(VkLayerProperties);
+    header.versionResult = snapshot.versionResult;
+    header.fingerprint = fingerprint;
+    header.version = snapshot.version;
+    header.extensionCount = static_cast<std::uint32_t>(snapshot.extensions.size());
+    header.layerCount = static_cast<std::uint32_t>(snapshot.layers.size());
+    std::vector<std::uint32_t> layerExtensionCounts;
+    layerExtensionCounts.reserve(snapshot.layerExtensions.size());
+    for (const auto& extensions : snapshot.layerExtensions) {
+        layerExtensionCounts.push_back(static_cast<std::uint32_t>(extensions.size()));
+        header.layerExtensionCount += layerExtensionCounts.back();
+    }
+    layerExtensionCounts.resize(snapshot.layers.size());
+
+    out.clear();
+    out.reserve(sizeof(header) + header.extensionCount * sizeof(VkExtensionProperties)
+        + header.layerCount * (sizeof(VkLayerProperties) + sizeof(std::uint32_t))
+        + header.layerExtensionCount * sizeof(VkExtensionProperties));
+    appendArray(out, &header, 1);
+    appendArray(out, snapshot.extensions.data(), snapshot.extensions.size());
+    appendArray(out, snapshot.layers.data(), snapshot.layers.size());
+    appendArray(out, layerExtensionCounts.data(), layerExtensionCounts.size());
+    for (const auto& extensions : snapshot.layerExtensions) {
+        appendArray(out, extensions.data(), extensions.size());
+    }
+}
+
+bool shw::readSnapshotFingerprint(const void* data, std::size_t size, std::uint64_t& fingerprint) {
+    SnapshotHeader header{};
+    if (!readHeader(data, size, header)) {
+        return false;
+    }
+    fingerprint = header.fingerprint;
+    return true;
+}
+
+bool shw::deserializeSnapshot(const void* data, std::size_t size, std::uint64_t& fingerprint, InstanceSnapshot& snapshot) {
+    SnapshotHeader header{};
+    if (!readHeader(data, size, header)) {
+        return false;
+    }
+    const std::uint64_t expectedSize{ sizeof(header)
+        + std::uint64_t{ header.extensionCount } * sizeof(VkExtensionProperties)
+        + std::uint64_t{ header.layerCount } * (sizeof(VkLayerProperties) + sizeof(std::uint32_t))
+        + std::uint64_t{ header.layerExtensionCount } * sizeof(VkExtensionProperties) };
+    if (expectedSize != size) {
+        return false;
+    }
+
+    const auto* in{ static_cast<const unsigned char*>(data) + sizeof(header) };
+    const auto* counts{ in + header.extensionCount * sizeof(VkExtensionProperties)
+        + header.layerCount * sizeof(VkLayerProperties) };
+    auto layerExtensionCount{ [&](std::uint32_t layer) {
+        std::uint32_t count{};
+        std::memcpy(&count, counts + layer * sizeof(count), sizeof(count));
+        return count;
+    } };
+    std::uint64_t total{};
+    for (std::uint32_t i{}; i < header.layerCount; ++i) {
+        total += layerExtensionCount(i);
+    }
+    if (total != header.layerExtensionCount) {
+        return false;
+    }
+    in = readArray(in, snapshot.extensions, header.extensionCount);
+    in = readArray(in, snapshot.layers, header.layerCount);
+    in += header.layerCount * sizeof(std::uint32_t);
+    snapshot.layerExtensions.resize(header.layerCount);
+    for (std::uint32_t i{}; i < header.layerCount; ++i) {
+        in = readArray(in, snapshot.layerExtensions[i], layerExtensionCount(i));
+    }
+    snapshot.versionResult = static_cast<VkResult>(header.versionResult);
+    snapshot.version = header.version;
+    fingerprint = header.fingerprint;
+    return true;
+}
+
+std::filesystem::path shw::snapshotCachePath() {
+    constexpr const char* fileName{ "instance-snapshot.bin" };
+    if (std::string dir{ getEnv("SHOW_VK_CACHE_DIR") }; !dir.empty()) {
+        return fs::path{ dir } / fileName;
+    }
+#ifdef _WIN32
+    const std::string base{ getEnv("LOCALAPPDATA") };
+    return base.empty() ? fs::path{} : fs::path{ base } / "show-vk" / fileName;
+#else
+    if (std::string base{ getEnv("XDG_CACHE_HOME") }; !base.empty()) {
+        return fs::path{ base } / "show-vk" / fileName;
+    }
+    const std::string home{ getEnv("HOME") };
+    return home.empty() ? fs::path{} : fs::path{ home } / ".cache" / "show-vk" / fileName;
+#endif
+}
+
+bool shw::loadCachedSnapshot(std::uint64_t fingerprint, InstanceSnapshot& snapshot) {
+    const fs::path path{ snapshotCachePath() };
+    if (path.empty()) {
+        return false;
+    }
+    const MappedFile file{ path };
+    // The fingerprint sits in the header, so a stale cache is rejected
+    // without reading the arrays.
+    std::uint64_t cachedFingerprint{};
+    return readSnapshotFingerprint(file.data(), file.size(), cachedFingerprint)
+        && cachedFingerprint == fingerprint
+        && deserializeSnapshot(file.data(), file.size(), cachedFingerprint, snapshot);
+}
+
+void shw::storeCachedSnapshot(std::uint64_t fingerprint, const InstanceSnapshot& snapshot) {
+    const fs::path path{ snapshotCachePath() };
+    if (path.empty()) {
+        return;
+    }
+    std::string data;
+    serializeSnapshot(snapshot, fingerprint, data);
+
+    // Write next to the target and rename so that concurrent readers only
+    // ever map a complete file. A failure here just means the next run probes again.
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    fs::path temporary{ path };
+#ifdef _WIN32
+    temporary += ".tmp." + std::to_string(GetCurrentProcessId());
+#else
+    temporary += ".tmp." + std::to_string(getpid());
+#endif
+    {
+        std::ofstream out{ temporary, std::ios::binary | std::ios::trunc };
+        if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            return;
+        }
+    }
+    fs::rename(temporary, path, error);
+    if (error) {
+        fs::remove(temporary, error);
+    }
+}
+
+void shw::takeCachedInstanceSnapshot(InstanceSnapshot& snapshot) {
+    // Each emplace() ends the previous trace section and starts the next.
+    std::optional<TraceScope> scope{ std::in_place, "loaderFingerprint" };
+    const std::uint64_t fingerprint{ loaderFingerprint() };
+    scope.emplace("loadCachedSnapshot");
+    if (loadCachedSnapshot(fingerprint, snapshot)) {
+        return;
+    }
+    scope.reset();
+    takeInstanceSnapshot(snapshot);
+    scope.emplace("storeCachedSnapshot");
+    storeCachedSnapshot(fingerprint, snapshot);
+}
+
+shw::InstanceSnapshot shw::takeCachedInstanceSnapshot() {
+    InstanceSnapshot snapshot;
+    takeCachedInstanceSnapshot(snapshot);
+    return snapshot;
+}
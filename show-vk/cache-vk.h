@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vulkan/vulkan.h>
+
+namespace shw {
+    struct InstanceSnapshot;
+
+    // Hash of the loader environment: the variables that steer driver and layer
+    // discovery plus the path, size and mtime of the loader library itself and
+    // of every manifest the loader would read. Opens the Vulkan library.
+    std::uint64_t loaderFingerprint();
+
+    // Binary snapshot layout shared by the cache file and anything else that
+    // needs to move a snapshot around. All arrays are stored as the raw Vulkan
+    // structs so a mapped file can be read back with plain copies.
+    void serializeSnapshot(const InstanceSnapshot& snapshot, std::uint64_t fingerprint, std::string& out);
+    bool deserializeSnapshot(const void* data, std::size_t size, std::uint64_t& fingerprint, InstanceSnapshot& snapshot);
+    // Validates only the header and returns its fingerprint.
+    bool readSnapshotFingerprint(const void* data, std::size_t size, std::uint64_t& fingerprint);
+
+    std::filesystem::path snapshotCachePath();
+    // On a miss the contents of snapshot are unspecified.
+    bool loadCachedSnapshot(std::uint64_t fingerprint, InstanceSnapshot& snapshot);
+    void storeCachedSnapshot(std::uint64_t fingerprint, const InstanceSnapshot& snapshot);
+
+    // Serves the snapshot from the cache file when the fingerprint matches,
+    // otherwise probes the loader and refreshes the cache.
+    InstanceSnapshot takeCachedInstanceSnapshot();
+    void takeCachedInstanceSnapshot(InstanceSnapshot& snapshot);
+}
@@ -0,0 +1,458 @@
+#include "configs-vk.h"
+#include "baseline-vk.h"
+#include "options-vk.h"
+#include "probe-vk.h"
+#include "table-vk.h"
+#include "thread-pool.h"
+#include "trace-vk.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <filesystem>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+extern char** environ;
+#endif
+
+namespace {
+    // Workers mostly wait on the loader and the drivers rather than the CPU,
+    // so they are not limited to one per core.
+    constexpr std::size_t maxConcurrentProbes{ 64 };
+
+    // Pipes are created and handed to the child under this lock so that no
+    // other worker inherits the write end and keeps the pipe open.
+    std::mutex spawnMutex;
+
+    std::string_view trim(std::string_view text) {
+        const std::size_t begin{ text.find_first_not_of(" \t\r") };
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    bool sameVariable(std::string_view a, std::string_view b) {
+#ifdef _WIN32
+        // Windows environment names are case-insensitive.
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y)); });
+#else
+        return a == b;
+#endif
+    }
+
+    // The inherited environment with the variables of config replaced.
+    std::vector<std::string> workerEnvironment(const shw::LoaderConfig& config) {
+        std::vector<std::string> environment;
+        auto overridden{ [&](std::string_view name) {
+            return std::any_of(config.environment.cbegin(), config.environment.cend(),
+                [&](const auto& variable) { return sameVariable(variable.first, name); });
+        } };
+#ifdef _WIN32
+        char* block{ GetEnvironmentStringsA() };
+        for (const char* entry{ block }; block != nullptr && *entry != '\0'; entry += std::strlen(entry) + 1) {
+            const std::string_view variable{ entry };
+            // Per-drive entries such as =C:=C:\dir start with '='.
+            if (!overridden(variable.substr(0, variable.find('=', 1)))) {
+                environment.emplace_back(variable);
+            }
+        }
+        FreeEnvironmentStringsA(block);
+#else
+        for (char** entry{ environ }; *entry != nullptr; ++entry) {
+            const std::string_view variable{ *entry };
+            if (!overridden(variable.substr(0, variable.find('=')))) {
+                environment.emplace_back(variable);
+            }
+        }
+#endif
+        for (const auto& [name, value] : config.environment) {
+            if (!value.empty()) {
+                environment.push_back(name + '=' + value);
+            }
+        }
+        return environment;
+    }
+
+    std::string executablePath(const char* argv0) {
+#ifdef _WIN32
+        char path[MAX_PATH];
+        const DWORD size{ GetModuleFileNameA(nullptr, path, MAX_PATH) };
+        if (size > 0 && size < MAX_PATH) {
+            return { path, size };
+        }
+#elif defined(__APPLE__)
+        char path[4096];
+        std::uint32_t size{ sizeof(path) };
+        if (_NSGetExecutablePath(path, &size) == 0) {
+            return path;
+        }
+#else
+        std::error_code error;
+        const std::filesystem::path path{ std::filesystem::read_symlink("/proc/self/exe", error) };
+        if (!error) {
+            return path.string();
+        }
+#endif
+        return argv0 != nullptr ? argv0 : "";
+    }
+
+#ifdef _WIN32
+    // Quotes one argument for CommandLineToArgvW-style parsing.
+    void appendArgument(std::string& commandLine, const std::string& argument) {
+        if (!commandLine.empty()) {
+            commandLine += ' ';
+        }
+        if (!argument.empty() && argument.find_first_of(" \t\"") == std::string::npos) {
+            commandLine += argument;
+            return;
+        }
+        commandLine += '"';
+        std::size_t backslashes{};
+        for (char c : argument) {
+            if (c == '\\') {
+                ++backslashes;
+                continue;
+            }
+            commandLine.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+            backslashes = 0;
+            commandLine += c;
+        }
+        commandLine.append(backslashes * 2, '\\');
+        commandLine += '"';
+    }
+
+    std::string lastError(const char* what) {
+        return std::string{ what } + " failed with error " + std::to_string(GetLastError());
+    }
+
+    // Runs the worker to completion and collects its stdout. Returns an error
+    // message, or an empty string when the worker succeeded.
+    std::string runWorker(const std::vector<std::string>& arguments, const std::vector<std::string>& environment,
+            std::string& output) {
+        std::string commandLine;
+        for (const auto& argument : arguments) {
+            appendArgument(commandLine, argument);
+        }
+        std::string environmentBlock;
+        for (const auto& variable : environment) {
+            environmentBlock += variable;
+            environmentBlock += '\0';
+        }
+        environmentBlock += '\0';
+
+        HANDLE readPipe{};
+        PROCESS_INFORMATION process{};
+        {
+            const std::lock_guard<std::mutex> lock{ spawnMutex };
+            SECURITY_ATTRIBUTES attributes{ static_cast<DWORD>(sizeof(attributes)), nullptr, TRUE };
+            HANDLE writePipe{};
+            if (!CreatePipe(&readPipe, &writePipe, &attributes, 0)) {
+                return lastError("CreatePipe()");
+            }
+            SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
+            STARTUPINFOA startup{ static_cast<DWORD>(sizeof(startup)) };
+            startup.dwFlags = STARTF_USESTDHANDLES;
+            startup.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+            startup.hStdOutput = writePipe;
+            startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+            const BOOL created{ CreateProcessA(arguments.front().c_str(), commandLine.data(), nullptr, nullptr, TRUE,
+                CREATE_NO_WINDOW, environmentBlock.data(), nullptr, &startup, &process) };
+            CloseHandle(writePipe);
+            if (!created) {
+                CloseHandle(readPipe);
+                return lastError("CreateProcess()");
+            }
+        }
+        char buffer[64 * 1024];
+        DWORD read{};
+        while (ReadFile(readPipe, buffer, sizeof(buffer), &read, nullptr) && read > 0) {
+            output.append(buffer, read);
+        }
+        CloseHandle(readPipe);
+        WaitForSingleObject(process.hProcess, INFINITE);
+        DWORD exitCode{};
+        GetExitCodeProcess(process.hProcess, &exitCode);
+        CloseHandle(process.hThread);
+        CloseHandle(process.hProcess);
+        if (exitCode != 0) {
+            return "Probe worker exited with code " + std::to_string(exitCode);
+        }
+        return {};
+    }
+#else
+    std::string runWorker(const std::vector<std::string>& arguments, const std::vector<std::string>& environment,
+            std::string& output) {
+        std::vector<char*> argv;
+        for (const auto& argument : arguments) {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+        std::vector<char*> envp;
+        for (const auto& variable : environment) {
+            envp.push_back(const_cast<char*>(variable.c_str()));
+        }
+        envp.push_back(nullptr);
+
+        int fds[2]{};
+        pid_t pid{};
+        {
+            const std::lock_guard<std::mutex> lock{ spawnMutex };
+            if (pipe(fds) != 0) {
+                return std::string{ "pipe() failed: " } + std::strerror(errno);
+            }
+            posix_spawn_file_actions_t actions;
+            posix_spawn_file_actions_init(&actions);
+            posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+            posix_spawn_file_actions_addclose(&actions, fds[0]);
+            posix_spawn_file_actions_addclose(&actions, fds[1]);
+            const int spawned{ posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), envp.data()) };
+            posix_spawn_file_actions_destroy(&actions);
+            close(fds[1]);
+            if (spawned != 0) {
+                close(fds[0]);
+                return "Cannot start " + arguments.front() + ": " + std::strerror(spawned);
+            }
+        }
+        char buffer[64 * 1024];
+        for (;;) {
+            const ssize_t count{ read(fds[0], buffer, sizeof(buffer)) };
+            if (count > 0) {
+                output.append(buffer, static_cast<std::size_t>(count));
+            }
+            else if (count == 0 || errno != EINTR) {
+                break;
+            }
+        }
+        close(fds[0]);
+        int status{};
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        if (WIFSIGNALED(status)) {
+            return "Probe worker killed by signal " + std::to_string(WTERMSIG(status));
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            return "Probe worker exited with code " + std::to_string(WEXITSTATUS(status));
+        }
+        return {};
+    }
+#endif
+
+    struct ConfigStatusRow {
+        std::string_view name;
+        std::string_view status;
+    };
+
+    constexpr shw::Column<ConfigStatusRow> configStatusColumns[]{
+        { "name", "Configuration", shw::Align::Left, [](const ConfigStatusRow& row) { return shw::Cell::str(row.name); } },
+        { "status", "Status", shw::Align::Left, [](const ConfigStatusRow& row) { return shw::Cell::str(row.status); } },
+    };
+
+    void printConfigStatus(const std::vector<shw::LoaderConfig>& configs, const std::vector<shw::ProbeResult>& probes) {
+        std::vector<std::string> statuses;
+        statuses.reserve(probes.size());
+        for (const auto& probe : probes) {
+            if (!probe.instanceError.empty()) {
+                statuses.push_back(probe.instanceError);
+            }
+            else if (!probe.deviceError.empty()) {
+                statuses.push_back("devices: " + probe.deviceError);
+            }
+            else {
+                statuses.push_back("ok (" + std::to_string(probe.devices.size()) + " devices)");
+            }
+        }
+        std::vector<ConfigStatusRow> rows;
+        rows.reserve(configs.size());
+        for (std::size_t i{}, length{ configs.size() }; i < length; ++i) {
+            rows.push_back({ configs[i].name, statuses[i] });
+        }
+        shw::renderTable(shw::output(), "configs", "Configurations:\n", configStatusColumns, rows);
+    }
+
+    // The machine formats get every row with a differs flag and one value per
+    // configuration, in the order of the configs table; text only shows the
+    // rows that differ, one column per configuration.
+    void printConfigDiff(const std::vector<shw::LoaderConfig>& configs, const std::vector<shw::ProbeDiffRow>& rows) {
+        shw::OutputBuffer& out{ shw::output() };
+        if (out.format() != shw::OutputFormat::Text) {
+            shw::beginTable(out, "configDifferences", rows.size());
+            for (const auto& row : rows) {
+                shw::beginRow(out, 4);
+                shw::writeRowCell(out, "section", shw::Cell::str(shw::probeSectionToStr(row.section)));
+                shw::writeRowCell(out, "name", shw::Cell::str(row.name));
+                shw::writeRowCell(out, "differs", shw::Cell::yesNo(row.differs));
+                shw::beginList(out, "values");
+                for (const auto& value : row.values) {
+                    shw::writeField(out, {}, {}, shw::Cell::str(value));
+                }
+                shw::endList(out);
+                shw::endRow(out);
+            }
+            shw::endTable(out);
+            shw::endSection(out);
+            return;
+        }
+
+        constexpr std::string_view sectionHeader{ "Section" };
+        constexpr std::string_view nameHeader{ "Name" };
+        const std::size_t columns{ configs.size() + 2 };
+        std::vector<std::size_t> widths(columns);
+        widths[0] = sectionHeader.size();
+        widths[1] = nameHeader.size();
+        for (std::size_t c{}; c < configs.size(); ++c) {
+            widths[c + 2] = configs[c].name.size();
+        }
+        std::size_t same{};
+        for (const auto& row : rows) {
+            if (!row.differs) {
+                ++same;
+                continue;
+            }
+            widths[0] = std::max(widths[0], shw::probeSectionToStr(row.section).size());
+            widths[1] = std::max(widths[1], row.name.size());
+            for (std::size_t c{}; c < row.values.size(); ++c) {
+                widths[c + 2] = std::max(widths[c + 2], row.values[c].size());
+            }
+        }
+        out.append("Configuration differences:\n");
+        if (same < rows.size()) {
+            out.append(shw::tableIndent);
+            shw::writeCell(out, sectionHeader, widths[0], shw::Align::Left, false);
+            shw::writeCell(out, nameHeader, widths[1], shw::Align::Left, false);
+            for (std::size_t c{}; c < configs.size(); ++c) {
+                shw::writeCell(out, configs[c].name, widths[c + 2], shw::Align::Left, c + 3 == columns);
+            }
+            for (const auto& row : rows) {
+                if (!row.differs) {
+                    continue;
+                }
+                out.append(shw::tableIndent);
+                shw::writeCell(out, shw::probeSectionToStr(row.section), widths[0], shw::Align::Left, false);
+                shw::writeCell(out, row.name, widths[1], shw::Align::Left, false);
+                for (std::size_t c{}; c < row.values.size(); ++c) {
+                    shw::writeCell(out, row.values[c], widths[c + 2], shw::Align::Left, c + 3 == columns);
+                }
+            }
+        }
+        out.append(std::to_string(same));
+        out.append(" of ");
+        out.append(std::to_string(rows.size()));
+        out.append(" entries are the same in every configuration.\n");
+    }
+}
+
+std::vector<shw::LoaderConfig> shw::readLoaderConfigs(const std::string& path) {
+    std::ifstream in{ path };
+    if (!in) {
+        throw std::runtime_error{ "Cannot open configs file: " + path };
+    }
+    std::vector<LoaderConfig> configs;
+    std::string text;
+    for (std::size_t lineNumber{ 1 }; std::getline(in, text); ++lineNumber) {
+        const std::string_view line{ trim(text) };
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        if (line.front() == '[' && line.back() == ']') {
+            const std::string_view name{ trim(line.substr(1, line.size() - 2)) };
+            if (name.empty() || std::any_of(configs.cbegin(), configs.cend(),
+                    [&](const LoaderConfig& config) { return config.name == name; })) {
+                throw std::runtime_error{ path + ':' + std::to_string(lineNumber) + ": empty or duplicate configuration name" };
+            }
+            configs.push_back({ std::string{ name }, {} });
+            continue;
+        }
+        const std::size_t delim{ line.find('=') };
+        if (configs.empty() || delim == std::string_view::npos || delim == 0) {
+            throw std::runtime_error{ path + ':' + std::to_string(lineNumber) + ": expected [name] or NAME=value" };
+        }
+        configs.back().environment.emplace_back(trim(line.substr(0, delim)), trim(line.substr(delim + 1)));
+    }
+    return configs;
+}
+
+void shw::runProbeWorker() {
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    std::string data;
+    serializeProbe(probeCapabilities(), data);
+    std::fwrite(data.data(), 1, data.size(), stdout);
+    std::fflush(stdout);
+}
+
+int shw::executeConfigOptions(const Options& options, const char* argv0) {
+    if (!options.isSet(Option::Configs)) {
+        return 0;
+    }
+    // Each emplace() ends the previous trace section and starts the next.
+    std::optional<TraceScope> scope{ std::in_place, "readLoaderConfigs" };
+    const std::string path{ options.value(Option::Configs) };
+    const std::vector<LoaderConfig> configs{ readLoaderConfigs(path) };
+    if (configs.empty()) {
+        throw std::runtime_error{ "No configurations in " + path };
+    }
+    std::vector<std::string> arguments{ executablePath(argv0), std::string{ optionName(Option::ProbeWorker) } };
+    if (options.isSet(Option::VulkanLibrary)) {
+        arguments.push_back(std::string{ optionName(Option::VulkanLibrary) } + '=' + std::string{ options.value(Option::VulkanLibrary) });
+    }
+
+    scope.emplace("probeConfigs");
+    std::vector<ProbeResult> probes(configs.size());
+    ThreadPool pool{ std::min(configs.size(), maxConcurrentProbes) };
+    pool.parallelFor(configs.size(), [&](std::size_t i) {
+        const TraceScope probeScope{ "probeConfig" };
+        std::string data;
+        std::string error{ runWorker(arguments, workerEnvironment(configs[i]), data) };
+        if (error.empty() && !deserializeProbe(data.data(), data.size(), probes[i])) {
+            error = "Unreadable probe worker output";
+        }
+        if (!error.empty()) {
+            probes[i] = {};
+            probes[i].instanceError = std::move(error);
+        }
+    });
+
+    scope.emplace("diffProbes");
+    std::vector<const ProbeResult*> results;
+    results.reserve(probes.size());
+    for (const auto& probe : probes) {
+        results.push_back(&probe);
+    }
+    const std::vector<ProbeDiffRow> rows{ diffProbes(results) };
+    scope.emplace("printConfigs");
+    printConfigStatus(configs, probes);
+    printConfigDiff(configs, rows);
+    // With every configuration failed there are no rows to differ, so check
+    // the probes themselves; the status table above says what went wrong.
+    if (std::any_of(probes.cbegin(), probes.cend(), [](const ProbeResult& probe) { return probe.failed(); })) {
+        return errorExitCode;
+    }
+    return std::any_of(rows.cbegin(), rows.cend(), [](const ProbeDiffRow& row) { return row.differs; }) ? driftExitCode : 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace shw {
+    class Options;
+
+    // One loader setup to probe, e.g. a driver image or a layer set.
+    struct LoaderConfig {
+        std::string name;
+        // Applied on top of the inherited environment; an empty value unsets
+        // the variable.
+        std::vector<std::pair<std::string, std::string>> environment;
+    };
+
+    // A --configs file lists one section per configuration:
+    //     [new-driver]
+    //     VK_DRIVER_FILES=/opt/new-driver/icd.json
+    //     VK_INSTANCE_LAYERS=
+    // Lines starting with # are comments.
+    std::vector<LoaderConfig> readLoaderConfigs(const std::string& path);
+
+    // --probe-worker: probes the loader of this process and writes the
+    // serialized ProbeResult to stdout for the parent show-vk to read.
+    void runProbeWorker();
+
+    // --configs: loader state is process-wide, so every configuration is
+    // probed in its own worker process. All workers run at once and the run
+    // takes about as long as the slowest of them. Returns errorExitCode when
+    // any configuration could not be probed, driftExitCode when any entry
+    // differs and 0 otherwise.
+    int executeConfigOptions(const Options& options, const char* argv0);
+}
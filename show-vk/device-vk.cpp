@@ -0,0 +1,833 @@
+#include "device-vk.h"
+#include "dispatch-vk.h"
+#include "error-vk.h"
+#include "format-vk.h"
+#include "instance-vk.h"
+#include "memory-bench-vk.h"
+#include "options-vk.h"
+#include "pipeline-bench-vk.h"
+#include "queue-bench-vk.h"
+#include "table-vk.h"
+#include "thread-pool.h"
+#include "trace-vk.h"
+#include "vk-tables.h"
+
+#include <array>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+
+namespace {
+    struct FeatureField {
+        const char* name;
+        std::size_t offset;
+    };
+
+#define SHW_FEATURE(type, field) FeatureField{ #field, offsetof(type, field) }
+
+    constexpr FeatureField vulkan10Features[]{
+        SHW_FEATURE(VkPhysicalDeviceFeatures, robustBufferAccess),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, fullDrawIndexUint32),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, imageCubeArray),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, independentBlend),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, geometryShader),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, tessellationShader),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sampleRateShading),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, dualSrcBlend),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, logicOp),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, multiDrawIndirect),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, drawIndirectFirstInstance),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, depthClamp),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, depthBiasClamp),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, fillModeNonSolid),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, depthBounds),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, wideLines),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, largePoints),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, alphaToOne),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, multiViewport),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, samplerAnisotropy),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, textureCompressionETC2),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, textureCompressionASTC_LDR),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, textureCompressionBC),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, occlusionQueryPrecise),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, pipelineStatisticsQuery),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, vertexPipelineStoresAndAtomics),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, fragmentStoresAndAtomics),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderTessellationAndGeometryPointSize),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderImageGatherExtended),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderStorageImageExtendedFormats),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderStorageImageMultisample),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderStorageImageReadWithoutFormat),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderStorageImageWriteWithoutFormat),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderUniformBufferArrayDynamicIndexing),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderSampledImageArrayDynamicIndexing),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderStorageBufferArrayDynamicIndexing),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderStorageImageArrayDynamicIndexing),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderClipDistance),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderCullDistance),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderFloat64),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderInt64),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderInt16),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderResourceResidency),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, shaderResourceMinLod),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseBinding),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseResidencyBuffer),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseResidencyImage2D),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseResidencyImage3D),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseResidency2Samples),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseResidency4Samples),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseResidency8Samples),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseResidency16Samples),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, sparseResidencyAliased),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, variableMultisampleRate),
+        SHW_FEATURE(VkPhysicalDeviceFeatures, inheritedQueries),
+    };
+
+    constexpr FeatureField vulkan11Features[]{
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, storageBuffer16BitAccess),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, uniformAndStorageBuffer16BitAccess),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, storagePushConstant16),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, storageInputOutput16),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, multiview),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, multiviewGeometryShader),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, multiviewTessellationShader),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, variablePointersStorageBuffer),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, variablePointers),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, protectedMemory),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, samplerYcbcrConversion),
+        SHW_FEATURE(VkPhysicalDeviceVulkan11Features, shaderDrawParameters),
+    };
+
+    constexpr FeatureField vulkan12Features[]{
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, samplerMirrorClampToEdge),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, drawIndirectCount),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, storageBuffer8BitAccess),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, uniformAndStorageBuffer8BitAccess),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, storagePushConstant8),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderBufferInt64Atomics),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderSharedInt64Atomics),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderFloat16),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderInt8),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderInputAttachmentArrayDynamicIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderUniformTexelBufferArrayDynamicIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderStorageTexelBufferArrayDynamicIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderUniformBufferArrayNonUniformIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderSampledImageArrayNonUniformIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderStorageBufferArrayNonUniformIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderStorageImageArrayNonUniformIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderInputAttachmentArrayNonUniformIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderUniformTexelBufferArrayNonUniformIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderStorageTexelBufferArrayNonUniformIndexing),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingUniformBufferUpdateAfterBind),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingSampledImageUpdateAfterBind),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingStorageImageUpdateAfterBind),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingStorageBufferUpdateAfterBind),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingUniformTexelBufferUpdateAfterBind),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingStorageTexelBufferUpdateAfterBind),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingUpdateUnusedWhilePending),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingPartiallyBound),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, descriptorBindingVariableDescriptorCount),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, runtimeDescriptorArray),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, samplerFilterMinmax),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, scalarBlockLayout),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, imagelessFramebuffer),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, uniformBufferStandardLayout),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderSubgroupExtendedTypes),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, separateDepthStencilLayouts),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, hostQueryReset),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, timelineSemaphore),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, bufferDeviceAddress),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, bufferDeviceAddressCaptureReplay),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, bufferDeviceAddressMultiDevice),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, vulkanMemoryModel),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, vulkanMemoryModelDeviceScope),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, vulkanMemoryModelAvailabilityVisibilityChains),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderOutputViewportIndex),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, shaderOutputLayer),
+        SHW_FEATURE(VkPhysicalDeviceVulkan12Features, subgroupBroadcastDynamicId),
+    };
+
+    constexpr FeatureField vulkan13Features[]{
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, robustImageAccess),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, inlineUniformBlock),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, descriptorBindingInlineUniformBlockUpdateAfterBind),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, pipelineCreationCacheControl),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, privateData),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, shaderDemoteToHelperInvocation),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, shaderTerminateInvocation),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, subgroupSizeControl),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, computeFullSubgroups),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, synchronization2),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, textureCompressionASTC_HDR),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, shaderZeroInitializeWorkgroupMemory),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, dynamicRendering),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, shaderIntegerDotProduct),
+        SHW_FEATURE(VkPhysicalDeviceVulkan13Features, maintenance4),
+    };
+
+#undef SHW_FEATURE
+
+    enum class LimitKind { U32, I32, F32, DeviceSize, Size, Bool, SampleCounts };
+
+    struct LimitField {
+        const char* name;
+        std::size_t offset;
+        LimitKind kind;
+        std::size_t count;
+    };
+
+#define SHW_LIMIT(field, kind) LimitField{ #field, offsetof(VkPhysicalDeviceLimits, field), LimitKind::kind, 1 }
+#define SHW_LIMIT_ARRAY(field, kind, count) LimitField{ #field, offsetof(VkPhysicalDeviceLimits, field), LimitKind::kind, count }
+
+    constexpr LimitField limitFields[]{
+        SHW_LIMIT(maxImageDimension1D, U32),
+        SHW_LIMIT(maxImageDimension2D, U32),
+        SHW_LIMIT(maxImageDimension3D, U32),
+        SHW_LIMIT(maxImageDimensionCube, U32),
+        SHW_LIMIT(maxImageArrayLayers, U32),
+        SHW_LIMIT(maxTexelBufferElements, U32),
+        SHW_LIMIT(maxUniformBufferRange, U32),
+        SHW_LIMIT(maxStorageBufferRange, U32),
+        SHW_LIMIT(maxPushConstantsSize, U32),
+        SHW_LIMIT(maxMemoryAllocationCount, U32),
+        SHW_LIMIT(maxSamplerAllocationCount, U32),
+        SHW_LIMIT(bufferImageGranularity, DeviceSize),
+        SHW_LIMIT(sparseAddressSpaceSize, DeviceSize),
+        SHW_LIMIT(maxBoundDescriptorSets, U32),
+        SHW_LIMIT(maxPerStageDescriptorSamplers, U32),
+        SHW_LIMIT(maxPerStageDescriptorUniformBuffers, U32),
+        SHW_LIMIT(maxPerStageDescriptorStorageBuffers, U32),
+        SHW_LIMIT(maxPerStageDescriptorSampledImages, U32),
+        SHW_LIMIT(maxPerStageDescriptorStorageImages, U32),
+        SHW_LIMIT(maxPerStageDescriptorInputAttachments, U32),
+        SHW_LIMIT(maxPerStageResources, U32),
+        SHW_LIMIT(maxDescriptorSetSamplers, U32),
+        SHW_LIMIT(maxDescriptorSetUniformBuffers, U32),
+        SHW_LIMIT(maxDescriptorSetUniformBuffersDynamic, U32),
+        SHW_LIMIT(maxDescriptorSetStorageBuffers, U32),
+        SHW_LIMIT(maxDescriptorSetStorageBuffersDynamic, U32),
+        SHW_LIMIT(maxDescriptorSetSampledImages, U32),
+        SHW_LIMIT(maxDescriptorSetStorageImages, U32),
+        SHW_LIMIT(maxDescriptorSetInputAttachments, U32),
+        SHW_LIMIT(maxVertexInputAttributes, U32),
+        SHW_LIMIT(maxVertexInputBindings, U32),
+        SHW_LIMIT(maxVertexInputAttributeOffset, U32),
+        SHW_LIMIT(maxVertexInputBindingStride, U32),
+        SHW_LIMIT(maxVertexOutputComponents, U32),
+        SHW_LIMIT(maxTessellationGenerationLevel, U32),
+        SHW_LIMIT(maxTessellationPatchSize, U32),
+        SHW_LIMIT(maxTessellationControlPerVertexInputComponents, U32),
+        SHW_LIMIT(maxTessellationControlPerVertexOutputComponents, U32),
+        SHW_LIMIT(maxTessellationControlPerPatchOutputComponents, U32),
+        SHW_LIMIT(maxTessellationControlTotalOutputComponents, U32),
+        SHW_LIMIT(maxTessellationEvaluationInputComponents, U32),
+        SHW_LIMIT(maxTessellationEvaluationOutputComponents, U32),
+        SHW_LIMIT(maxGeometryShaderInvocations, U32),
+        SHW_LIMIT(maxGeometryInputComponents, U32),
+        SHW_LIMIT(maxGeometryOutputComponents, U32),
+        SHW_LIMIT(maxGeometryOutputVertices, U32),
+        SHW_LIMIT(maxGeometryTotalOutputComponents, U32),
+        SHW_LIMIT(maxFragmentInputComponents, U32),
+        SHW_LIMIT(maxFragmentOutputAttachments, U32),
+        SHW_LIMIT(maxFragmentDualSrcAttachments, U32),
+        SHW_LIMIT(maxFragmentCombinedOutputResources, U32),
+        SHW_LIMIT(maxComputeSharedMemorySize, U32),
+        SHW_LIMIT_ARRAY(maxComputeWorkGroupCount, U32, 3),
+        SHW_LIMIT(maxComputeWorkGroupInvocations, U32),
+        SHW_LIMIT_ARRAY(maxComputeWorkGroupSize, U32, 3),
+        SHW_LIMIT(subPixelPrecisionBits, U32),
+        SHW_LIMIT(subTexelPrecisionBits, U32),
+        SHW_LIMIT(mipmapPrecisionBits, U32),
+        SHW_LIMIT(maxDrawIndexedIndexValue, U32),
+        SHW_LIMIT(maxDrawIndirectCount, U32),
+        SHW_LIMIT(maxSamplerLodBias, F32),
+        SHW_LIMIT(maxSamplerAnisotropy, F32),
+        SHW_LIMIT(maxViewports, U32),
+        SHW_LIMIT_ARRAY(maxViewportDimensions, U32, 2),
+        SHW_LIMIT_ARRAY(viewportBoundsRange, F32, 2),
+        SHW_LIMIT(viewportSubPixelBits, U32),
+        SHW_LIMIT(minMemoryMapAlignment, Size),
+        SHW_LIMIT(minTexelBufferOffsetAlignment, DeviceSize),
+        SHW_LIMIT(minUniformBufferOffsetAlignment, DeviceSize),
+        SHW_LIMIT(minStorageBufferOffsetAlignment, DeviceSize),
+        SHW_LIMIT(minTexelOffset, I32),
+        SHW_LIMIT(maxTexelOffset, U32),
+        SHW_LIMIT(minTexelGatherOffset, I32),
+        SHW_LIMIT(maxTexelGatherOffset, U32),
+        SHW_LIMIT(minInterpolationOffset, F32),
+        SHW_LIMIT(maxInterpolationOffset, F32),
+        SHW_LIMIT(subPixelInterpolationOffsetBits, U32),
+        SHW_LIMIT(maxFramebufferWidth, U32),
+        SHW_LIMIT(maxFramebufferHeight, U32),
+        SHW_LIMIT(maxFramebufferLayers, U32),
+        SHW_LIMIT(framebufferColorSampleCounts, SampleCounts),
+        SHW_LIMIT(framebufferDepthSampleCounts, SampleCounts),
+        SHW_LIMIT(framebufferStencilSampleCounts, SampleCounts),
+        SHW_LIMIT(framebufferNoAttachmentsSampleCounts, SampleCounts),
+        SHW_LIMIT(maxColorAttachments, U32),
+        SHW_LIMIT(sampledImageColorSampleCounts, SampleCounts),
+        SHW_LIMIT(sampledImageIntegerSampleCounts, SampleCounts),
+        SHW_LIMIT(sampledImageDepthSampleCounts, SampleCounts),
+        SHW_LIMIT(sampledImageStencilSampleCounts, SampleCounts),
+        SHW_LIMIT(storageImageSampleCounts, SampleCounts),
+        SHW_LIMIT(maxSampleMaskWords, U32),
+        SHW_LIMIT(timestampComputeAndGraphics, Bool),
+        SHW_LIMIT(timestampPeriod, F32),
+        SHW_LIMIT(maxClipDistances, U32),
+        SHW_LIMIT(maxCullDistances, U32),
+        SHW_LIMIT(maxCombinedClipAndCullDistances, U32),
+        SHW_LIMIT(discreteQueuePriorities, U32),
+        SHW_LIMIT_ARRAY(pointSizeRange, F32, 2),
+        SHW_LIMIT_ARRAY(lineWidthRange, F32, 2),
+        SHW_LIMIT(pointSizeGranularity, F32),
+        SHW_LIMIT(lineWidthGranularity, F32),
+        SHW_LIMIT(strictLines, Bool),
+        SHW_LIMIT(standardSampleLocations, Bool),
+        SHW_LIMIT(optimalBufferCopyOffsetAlignment, DeviceSize),
+        SHW_LIMIT(optimalBufferCopyRowPitchAlignment, DeviceSize),
+        SHW_LIMIT(nonCoherentAtomSize, DeviceSize),
+    };
+
+#undef SHW_LIMIT
+#undef SHW_LIMIT_ARRAY
+
+    template<const auto& names>
+    std::string_view formatFlags(const shw::Cell& cell, shw::CellBuffer& buffer) {
+        shw::CellWriter writer{ buffer };
+        std::uint64_t flags{ cell.unsignedValue };
+        for (const auto& flag : names) {
+            if (flags & flag.bit) {
+                writer.append(writer.empty() ? "" : " | ");
+                writer.append(flag.name);
+                flags &= ~flag.bit;
+            }
+        }
+        if (flags != 0) {
+            writer.append(writer.empty() ? "0x" : " | 0x");
+            writer.appendHex(flags);
+        }
+        return writer.empty() ? "NONE" : writer.text();
+    }
+
+    // Flag bits spelled out by name, e.g. DEVICE_LOCAL | HOST_VISIBLE.
+    template<const auto& names>
+    shw::Cell flagsCell(VkFlags flags) {
+        return shw::Cell::custom(formatFlags<names>, nullptr, flags);
+    }
+
+    void appendSampleCounts(shw::CellWriter& writer, VkSampleCountFlags counts) {
+        bool first{ true };
+        for (std::uint32_t bit{ 1 }; bit <= VK_SAMPLE_COUNT_64_BIT; bit <<= 1) {
+            if (counts & bit) {
+                writer.append(first ? "" : " ");
+                writer.appendNumber(std::uint64_t{ bit });
+                first = false;
+            }
+        }
+        if (first) {
+            writer.append("NONE");
+        }
+    }
+
+    std::string_view formatUuid(const shw::Cell& cell, shw::CellBuffer& buffer) {
+        const auto* uuid{ static_cast<const std::uint8_t*>(cell.data) };
+        shw::CellWriter writer{ buffer };
+        for (std::size_t i{}; i < VK_UUID_SIZE; ++i) {
+            writer.appendHex(uuid[i], 2);
+            if (i == 3 || i == 5 || i == 7 || i == 9) {
+                writer.append('-');
+            }
+        }
+        return writer.text();
+    }
+
+    std::string_view formatConformanceVersion(const shw::Cell& cell, shw::CellBuffer& buffer) {
+        const auto& version{ *static_cast<const VkConformanceVersion*>(cell.data) };
+        shw::CellWriter writer{ buffer };
+        writer.appendNumber(std::uint64_t{ version.major });
+        writer.append('.');
+        writer.appendNumber(std::uint64_t{ version.minor });
+        writer.append('.');
+        writer.appendNumber(std::uint64_t{ version.subminor });
+        writer.append('.');
+        writer.appendNumber(std::uint64_t{ version.patch });
+        return writer.text();
+    }
+
+    std::string_view formatExtent(const shw::Cell& cell, shw::CellBuffer& buffer) {
+        const auto& extent{ *static_cast<const VkExtent3D*>(cell.data) };
+        shw::CellWriter writer{ buffer };
+        writer.appendNumber(std::uint64_t{ extent.width });
+        writer.append('x');
+        writer.appendNumber(std::uint64_t{ extent.height });
+        writer.append('x');
+        writer.appendNumber(std::uint64_t{ extent.depth });
+        return writer.text();
+    }
+
+    template<typename T>
+    T readLimit(const unsigned char* base, std::uint64_t index) {
+        T value{};
+        std::memcpy(&value, base + index * sizeof(value), sizeof(value));
+        return value;
+    }
+
+    // The cell points at the first element and unsignedValue holds the count.
+    template<LimitKind kind>
+    std::string_view formatLimit(const shw::Cell& cell, shw::CellBuffer& buffer) {
+        const auto* base{ static_cast<const unsigned char*>(cell.data) };
+        shw::CellWriter writer{ buffer };
+        for (std::uint64_t i{}; i < cell.unsignedValue; ++i) {
+            if (i > 0) {
+                writer.append(", ");
+            }
+            if constexpr (kind == LimitKind::U32) {
+                writer.appendNumber(std::uint64_t{ readLimit<std::uint32_t>(base, i) });
+            }
+            else if constexpr (kind == LimitKind::I32) {
+                writer.appendNumber(std::int64_t{ readLimit<std::int32_t>(base, i) });
+            }
+            else if constexpr (kind == LimitKind::F32) {
+                writer.appendNumber(double{ readLimit<float>(base, i) });
+            }
+            else if constexpr (kind == LimitKind::DeviceSize) {
+                writer.appendNumber(std::uint64_t{ readLimit<VkDeviceSize>(base, i) });
+            }
+            else if constexpr (kind == LimitKind::Size) {
+                writer.appendNumber(static_cast<std::uint64_t>(readLimit<std::size_t>(base, i)));
+            }
+            else if constexpr (kind == LimitKind::Bool) {
+                writer.append(readLimit<VkBool32>(base, i) ? "YES" : "NO");
+            }
+            else {
+                appendSampleCounts(writer, readLimit<VkSampleCountFlags>(base, i));
+            }
+        }
+        return writer.text();
+    }
+
+    shw::Cell limitCell(const VkPhysicalDeviceLimits& limits, const LimitField& field) {
+        const auto* base{ reinterpret_cast<const unsigned char*>(&limits) + field.offset };
+        switch (field.kind) {
+        case LimitKind::U32: return shw::Cell::custom(formatLimit<LimitKind::U32>, base, field.count);
+        case LimitKind::I32: return shw::Cell::custom(formatLimit<LimitKind::I32>, base, field.count);
+        case LimitKind::F32: return shw::Cell::custom(formatLimit<LimitKind::F32>, base, field.count);
+        case LimitKind::DeviceSize: return shw::Cell::custom(formatLimit<LimitKind::DeviceSize>, base, field.count);
+        case LimitKind::Size: return shw::Cell::custom(formatLimit<LimitKind::Size>, base, field.count);
+        case LimitKind::Bool: return shw::Cell::custom(formatLimit<LimitKind::Bool>, base, field.count);
+        case LimitKind::SampleCounts: return shw::Cell::custom(formatLimit<LimitKind::SampleCounts>, base, field.count);
+        }
+        return {};
+    }
+
+    constexpr shw::Column<shw::NameValueRow> propertyColumns[]{
+        { "property", "Property", shw::Align::Left, [](const shw::NameValueRow& row) { return shw::Cell::str(row.name); } },
+        { "value", "Value", shw::Align::Left, [](const shw::NameValueRow& row) { return row.value; } },
+    };
+
+    constexpr shw::Column<shw::NameValueRow> limitColumns[]{
+        { "limit", "Limit", shw::Align::Left, [](const shw::NameValueRow& row) { return shw::Cell::str(row.name); } },
+        { "value", "Value", shw::Align::Left, [](const shw::NameValueRow& row) { return row.value; } },
+    };
+
+    constexpr shw::Column<shw::SupportRow> featureColumns[]{
+        { "feature", "Feature", shw::Align::Left, [](const shw::SupportRow& row) { return shw::Cell::str(row.name); } },
+        { "supported", "Supported", shw::Align::Left, [](const shw::SupportRow& row) { return shw::Cell::yesNo(row.supported); } },
+    };
+
+    struct HeapRow {
+        std::uint32_t index;
+        const VkMemoryHeap* heap;
+    };
+
+    constexpr shw::Column<HeapRow> heapColumns[]{
+        { "heap", "Heap", shw::Align::Right, [](const HeapRow& row) { return shw::Cell::number(row.index); } },
+        { "size", "Size", shw::Align::Right, [](const HeapRow& row) { return shw::Cell::number(row.heap->size); } },
+        { "sizeMiB", "Size MiB", shw::Align::Right, [](const HeapRow& row) { return shw::Cell::number(row.heap->size >> 20); } },
+        { "flags", "Flags", shw::Align::Left, [](const HeapRow& row) {
+            return flagsCell<shw::vk::memoryHeapFlagNames>(row.heap->flags); } },
+    };
+
+    struct MemoryTypeRow {
+        std::uint32_t index;
+        const VkMemoryType* type;
+    };
+
+    constexpr shw::Column<MemoryTypeRow> memoryTypeColumns[]{
+        { "type", "Type", shw::Align::Right, [](const MemoryTypeRow& row) { return shw::Cell::number(row.index); } },
+        { "heap", "Heap", shw::Align::Right, [](const MemoryTypeRow& row) { return shw::Cell::number(row.type->heapIndex); } },
+        { "flags", "Flags", shw::Align::Left, [](const MemoryTypeRow& row) {
+            return flagsCell<shw::vk::memoryPropertyFlagNames>(row.type->propertyFlags); } },
+    };
+
+    struct QueueRow {
+        std::size_t index;
+        const VkQueueFamilyProperties* family;
+    };
+
+    constexpr shw::Column<QueueRow> queueColumns[]{
+        { "family", "Family", shw::Align::Right, [](const QueueRow& row) { return shw::Cell::number(row.index); } },
+        { "queues", "Queues", shw::Align::Right, [](const QueueRow& row) { return shw::Cell::number(row.family->queueCount); } },
+        { "flags", "Flags", shw::Align::Left, [](const QueueRow& row) {
+            return flagsCell<shw::vk::queueFlagNames>(row.family->queueFlags); } },
+        { "timestampValidBits", "Timestamp Bits", shw::Align::Right, [](const QueueRow& row) { return shw::Cell::number(row.family->timestampValidBits); } },
+        { "minImageTransferGranularity", "Transfer Granularity", shw::Align::Left, [](const QueueRow& row) {
+            return shw::Cell::custom(formatExtent, &row.family->minImageTransferGranularity); } },
+    };
+
+    template<typename Features, std::size_t N>
+    void printFeatures(std::string_view key, std::string_view title, const Features& features, const FeatureField (&fields)[N]) {
+        std::array<shw::SupportRow, N> rows;
+        for (std::size_t i{}; i < N; ++i) {
+            VkBool32 value{};
+            std::memcpy(&value, reinterpret_cast<const unsigned char*>(&features) + fields[i].offset, sizeof(value));
+            rows[i] = { fields[i].name, value == VK_TRUE };
+        }
+        shw::renderTable(shw::output(), key, title, featureColumns, rows.data(), rows.size());
+    }
+}
+
+shw::ProbeInstance::ProbeInstance() {
+    std::uint32_t loaderVersion{ VK_API_VERSION_1_0 };
+    if (SHW_VK_CALL(vkEnumerateInstanceVersion, &loaderVersion) != VK_SUCCESS) {
+        loaderVersion = VK_API_VERSION_1_0;
+    }
+    apiVersion_ = std::min(loaderVersion, VK_API_VERSION_1_3);
+
+    // Portability drivers (e.g. MoltenVK) are only enumerated when asked for.
+    std::vector<const char*> enabledExtensions;
+    VkInstanceCreateFlags flags{};
+    const auto extensions{ getInstanceExtensions() };
+    if (std::any_of(extensions.cbegin(), extensions.cend(), [](const auto& extension) {
+            return std::strcmp(extension.extensionName, VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME) == 0; })) {
+        enabledExtensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+        flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
+    }
+
+    VkApplicationInfo applicationInfo{};
+    applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    applicationInfo.pApplicationName = "show-vk";
+    applicationInfo.applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
+    applicationInfo.apiVersion = apiVersion_;
+    VkInstanceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    createInfo.flags = flags;
+    createInfo.pApplicationInfo = &applicationInfo;
+    createInfo.enabledExtensionCount = static_cast<std::uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
+    VkResult result{ SHW_VK_CALL(vkCreateInstance, &createInfo, nullptr, &instance_) };
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error{ getError("vkCreateInstance() failed", result) };
+    }
+    loadInstanceFunctions(instance_);
+}
+
+shw::ProbeInstance::~ProbeInstance() {
+    SHW_VK_CALL(vkDestroyInstance, instance_, nullptr);
+}
+
+std::vector<VkPhysicalDevice> shw::getPhysicalDevices(VkInstance instance) {
+    std::vector<VkPhysicalDevice> devices;
+    std::uint32_t count{};
+    VkResult result{};
+    do {
+        result = SHW_VK_CALL(vkEnumeratePhysicalDevices, instance, &count, nullptr);
+        if (result != VK_SUCCESS) {
+            break;
+        }
+        devices.resize(count);
+        result = SHW_VK_CALL(vkEnumeratePhysicalDevices, instance, &count, devices.data());
+    } while (result == VK_INCOMPLETE);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error{ getError("vkEnumeratePhysicalDevices() failed", result) };
+    }
+    devices.resize(count);
+    return devices;
+}
+
+std::vector<VkExtensionProperties> shw::getDeviceExtensions(VkPhysicalDevice device) {
+    std::vector<VkExtensionProperties> extensions;
+    std::uint32_t count{};
+    VkResult result{};
+    do {
+        result = SHW_VK_CALL(vkEnumerateDeviceExtensionProperties, device, nullptr, &count, nullptr);
+        if (result != VK_SUCCESS) {
+            break;
+        }
+        extensions.resize(count);
+        result = SHW_VK_CALL(vkEnumerateDeviceExtensionProperties, device, nullptr, &count, extensions.data());
+    } while (result == VK_INCOMPLETE);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error{ getError("vkEnumerateDeviceExtensionProperties() failed", result) };
+    }
+    extensions.resize(count);
+    return extensions;
+}
+
+shw::DeviceInfo shw::getDeviceInfo(VkPhysicalDevice device, std::uint32_t instanceApiVersion) {
+    DeviceInfo info;
+    info.device = device;
+    SHW_VK_CALL(vkGetPhysicalDeviceProperties, device, &info.properties);
+    // A device may not use more than the application asked for at instance creation.
+    info.apiVersion = std::min(info.properties.apiVersion, instanceApiVersion);
+
+    if (info.apiVersion >= VK_API_VERSION_1_1) {
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        if (info.apiVersion >= VK_API_VERSION_1_2) {
+            info.properties11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES;
+            info.properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+            info.features11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+            info.features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            properties2.pNext = &info.properties11;
+            info.properties11.pNext = &info.properties12;
+            features2.pNext = &info.features11;
+            info.features11.pNext = &info.features12;
+        }
+        if (info.apiVersion >= VK_API_VERSION_1_3) {
+            info.features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+            info.features12.pNext = &info.features13;
+        }
+        SHW_VK_CALL(vkGetPhysicalDeviceProperties2, device, &properties2);
+        SHW_VK_CALL(vkGetPhysicalDeviceFeatures2, device, &features2);
+        info.properties = properties2.properties;
+        info.features = features2.features;
+        // The chain points into info itself; don't let copies carry it around.
+        info.properties11.pNext = nullptr;
+        info.features11.pNext = nullptr;
+        info.features12.pNext = nullptr;
+    }
+    else {
+        SHW_VK_CALL(vkGetPhysicalDeviceFeatures, device, &info.features);
+    }
+
+    SHW_VK_CALL(vkGetPhysicalDeviceMemoryProperties, device, &info.memory);
+    std::uint32_t queueFamilyCount{};
+    SHW_VK_CALL(vkGetPhysicalDeviceQueueFamilyProperties, device, &queueFamilyCount, nullptr);
+    info.queueFamilies.resize(queueFamilyCount);
+    SHW_VK_CALL(vkGetPhysicalDeviceQueueFamilyProperties, device, &queueFamilyCount, info.queueFamilies.data());
+    info.queueFamilies.resize(queueFamilyCount);
+    info.extensions = getDeviceExtensions(device);
+    return info;
+}
+
+std::vector<shw::DeviceInfo> shw::getDevicesInfo(const ProbeInstance& instance, ThreadPool& pool) {
+    const std::vector<VkPhysicalDevice> devices{ getPhysicalDevices(instance.get()) };
+    std::vector<DeviceInfo> infos(devices.size());
+    pool.parallelFor(devices.size(), [&](std::size_t i) {
+        const TraceScope scope{ "getDeviceInfo" };
+        infos[i] = getDeviceInfo(devices[i], instance.apiVersion());
+    });
+    return infos;
+}
+
+std::string_view shw::deviceTypeToStr(VkPhysicalDeviceType type) {
+    constexpr std::string_view prefix{ "VK_PHYSICAL_DEVICE_TYPE_" };
+    std::string_view name{ vk::enumName(vk::physicalDeviceTypeNames, type) };
+    if (name.empty()) {
+        return "UNKNOWN_DEVICE_TYPE";
+    }
+    name.remove_prefix(prefix.size());
+    return name;
+}
+
+std::string shw::versionToStr(std::uint32_t version) {
+    return std::to_string(VK_API_VERSION_VARIANT(version))
+        + '.' + std::to_string(VK_API_VERSION_MAJOR(version))
+        + '.' + std::to_string(VK_API_VERSION_MINOR(version))
+        + '.' + std::to_string(VK_API_VERSION_PATCH(version));
+}
+
+std::string shw::hexToStr(std::uint32_t value) {
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "0x%04x", static_cast<unsigned>(value));
+    return buffer;
+}
+
+void shw::printDeviceProperties(const DeviceInfo& info) {
+    const auto& properties{ info.properties };
+    std::vector<NameValueRow> rows{
+        { "Device Name", Cell::fixed(properties.deviceName) },
+        { "Device Type", Cell::str(deviceTypeToStr(properties.deviceType)) },
+        { "API Version", Cell::version(properties.apiVersion) },
+        { "Driver Version", Cell::hex(properties.driverVersion) },
+        { "Vendor ID", Cell::hex(properties.vendorID) },
+        { "Device ID", Cell::hex(properties.deviceID) },
+        { "Pipeline Cache UUID", Cell::custom(formatUuid, properties.pipelineCacheUUID) },
+    };
+    if (info.properties11.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES) {
+        rows.push_back({ "Device UUID", Cell::custom(formatUuid, info.properties11.deviceUUID) });
+        rows.push_back({ "Driver UUID", Cell::custom(formatUuid, info.properties11.driverUUID) });
+        rows.push_back({ "Subgroup Size", Cell::number(info.properties11.subgroupSize) });
+        rows.push_back({ "Max Memory Allocation Size", Cell::number(info.properties11.maxMemoryAllocationSize) });
+    }
+    if (info.properties12.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES) {
+        rows.push_back({ "Driver Name", Cell::fixed(info.properties12.driverName) });
+        rows.push_back({ "Driver Info", Cell::fixed(info.properties12.driverInfo) });
+        rows.push_back({ "Conformance Version", Cell::custom(formatConformanceVersion, &info.properties12.conformanceVersion) });
+    }
+    renderTable(output(), "properties", "Device properties:\n", propertyColumns, rows);
+}
+
+void shw::printDeviceFeatures(const DeviceInfo& info) {
+    printFeatures("features", "Device features (Vulkan 1.0):\n", info.features, vulkan10Features);
+    if (info.features11.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES) {
+        printFeatures("features11", "Device features (Vulkan 1.1):\n", info.features11, vulkan11Features);
+    }
+    if (info.features12.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES) {
+        printFeatures("features12", "Device features (Vulkan 1.2):\n", info.features12, vulkan12Features);
+    }
+    if (info.features13.sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES) {
+        printFeatures("features13", "Device features (Vulkan 1.3):\n", info.features13, vulkan13Features);
+    }
+}
+
+void shw::printDeviceLimits(const DeviceInfo& info) {
+    std::vector<NameValueRow> rows;
+    rows.reserve(std::size(limitFields));
+    for (const auto& field : limitFields) {
+        rows.push_back({ field.name, limitCell(info.properties.limits, field) });
+    }
+    renderTable(output(), "limits", "Device limits:\n", limitColumns, rows);
+}
+
+void shw::printDeviceMemory(const DeviceInfo& info) {
+    std::vector<HeapRow> heapRows;
+    heapRows.reserve(info.memory.memoryHeapCount);
+    for (std::uint32_t i{}; i < info.memory.memoryHeapCount; ++i) {
+        heapRows.push_back({ i, &info.memory.memoryHeaps[i] });
+    }
+    renderTable(output(), "memoryHeaps", "Device memory heaps:\n", heapColumns, heapRows);
+
+    std::vector<MemoryTypeRow> typeRows;
+    typeRows.reserve(info.memory.memoryTypeCount);
+    for (std::uint32_t i{}; i < info.memory.memoryTypeCount; ++i) {
+        typeRows.push_back({ i, &info.memory.memoryTypes[i] });
+    }
+    renderTable(output(), "memoryTypes", "Device memory types:\n", memoryTypeColumns, typeRows);
+}
+
+void shw::printDeviceQueues(const DeviceInfo& info) {
+    std::vector<QueueRow> rows;
+    rows.reserve(info.queueFamilies.size());
+    for (std::size_t i{}, length{ info.queueFamilies.size() }; i < length; ++i) {
+        rows.push_back({ i, &info.queueFamilies[i] });
+    }
+    renderTable(output(), "queueFamilies", "Device queue families:\n", queueColumns, rows);
+}
+
+void shw::printDeviceExtensions(const DeviceInfo& info) {
+    renderTable(output(), "extensions", "Device extensions:\n", extensionColumns, info.extensions);
+}
+
+void shw::executeDeviceOptions(const Options& options) {
+    auto isSet{ [&](Option option) { return options.isSet(option); } };
+    const bool all{ isSet(Option::DeviceAll) };
+    const bool showProperties{ all || isSet(Option::DeviceProperties) };
+    const bool showFeatures{ all || isSet(Option::DeviceFeatures) };
+    const bool showLimits{ all || isSet(Option::DeviceLimits) };
+    const bool showMemory{ all || isSet(Option::DeviceMemory) };
+    const bool showQueues{ all || isSet(Option::DeviceQueues) };
+    const bool showExtensions{ all || isSet(Option::DeviceExtensions) };
+    // The format matrix is hundreds of rows per device, so --device-all leaves it out.
+    const bool showFormats{ isSet(Option::DeviceFormats) };
+    const bool queryFormats{ isSet(Option::DeviceFormatsQuery) };
+    const bool benchMemory{ isSet(Option::DeviceMemoryBench) };
+    const bool benchQueues{ isSet(Option::DeviceQueueBench) };
+    const bool benchPipelines{ isSet(Option::DevicePipelineBench) };
+    std::size_t pipelineThreads{};
+    if (isSet(Option::DevicePipelineThreads)) {
+        const std::string_view text{ options.value(Option::DevicePipelineThreads) };
+        const auto [end, error]{ std::from_chars(text.data(), text.data() + text.size(), pipelineThreads) };
+        if (error != std::errc{} || end != text.data() + text.size() || pipelineThreads == 0) {
+            throw std::runtime_error{ "Invalid thread count: " + std::string{ text } };
+        }
+    }
+    // Parsed before any device is probed so a bad query fails up front.
+    FormatQuery formatQuery;
+    if (queryFormats) {
+        formatQuery = parseFormatQuery(options.values(Option::DeviceFormatsQuery));
+    }
+    if (!showProperties && !showFeatures && !showLimits && !showMemory && !showQueues && !showExtensions
+            && !showFormats && !queryFormats && !benchMemory && !benchQueues && !benchPipelines) {
+        return;
+    }
+
+    // Each emplace() ends the previous trace section and starts the next.
+    std::optional<TraceScope> scope{ std::in_place, "createProbeInstance" };
+    const ProbeInstance instance;
+    ThreadPool pool;
+    scope.emplace("getDevicesInfo");
+    const std::vector<DeviceInfo> devices{ getDevicesInfo(instance, pool) };
+    std::vector<FormatMatrix> formats;
+    if (showFormats || queryFormats) {
+        scope.emplace("getFormatMatrices");
+        formats = getFormatMatrices(devices, pool);
+    }
+    scope.emplace("printDevices");
+    OutputBuffer& out{ output() };
+    beginList(out, "devices");
+    for (std::size_t i{}, length{ devices.size() }; i < length; ++i) {
+        const auto& info{ devices[i] };
+        const std::string_view type{ deviceTypeToStr(info.properties.deviceType) };
+        beginObject(out, {});
+        if (out.format() == OutputFormat::Text) {
+            CellBuffer buffer;
+            out.append("Device ");
+            out.append(formatCell(Cell::number(i), buffer));
+            out.append(": ");
+            out.append(Cell::fixed(info.properties.deviceName).text);
+            out.append(" (");
+            out.append(type);
+            out.append(")\n");
+        }
+        else {
+            writeField(out, "index", {}, Cell::number(i));
+            writeField(out, "name", {}, Cell::fixed(info.properties.deviceName));
+            writeField(out, "type", {}, Cell::str(type));
+        }
+        if (showProperties) {
+            printDeviceProperties(info);
+        }
+        if (showFeatures) {
+            printDeviceFeatures(info);
+        }
+        if (showLimits) {
+            printDeviceLimits(info);
+        }
+        if (showMemory) {
+            printDeviceMemory(info);
+        }
+        if (showQueues) {
+            printDeviceQueues(info);
+        }
+        if (showExtensions) {
+            printDeviceExtensions(info);
+        }
+        if (showFormats) {
+            printFormatMatrix(formats[i]);
+        }
+        if (queryFormats) {
+            printFormatQuery(formats[i], formatQuery);
+        }
+        if (benchMemory) {
+            printDeviceMemoryBench(info);
+        }
+        if (benchQueues) {
+            printDeviceQueueBench(info);
+        }
+        if (benchPipelines) {
+            printDevicePipelineBench(info, pipelineThreads);
+        }
+        endObject(out);
+    }
+    endList(out);
+    endSection(out);
+}
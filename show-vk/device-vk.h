@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace shw {
+    class Options;
+    class ThreadPool;
+
+    // Owns the VkInstance used for everything below the instance level.
+    class ProbeInstance {
+    public:
+        ProbeInstance();
+        ~ProbeInstance();
+
+        ProbeInstance(const ProbeInstance&) = delete;
+        ProbeInstance& operator=(const ProbeInstance&) = delete;
+
+        VkInstance get() const { return instance_; }
+        // Version requested in VkApplicationInfo, which caps what devices may use.
+        std::uint32_t apiVersion() const { return apiVersion_; }
+
+    private:
+        VkInstance instance_{};
+        std::uint32_t apiVersion_{ VK_API_VERSION_1_0 };
+    };
+
+    // Everything show-vk reports about one physical device. The 1.1/1.2/1.3
+    // structs are only filled in when the device exposes that version; their
+    // sType is left zero otherwise.
+    struct DeviceInfo {
+        VkPhysicalDevice device{};
+        std::uint32_t apiVersion{};
+        VkPhysicalDeviceProperties properties{};
+        VkPhysicalDeviceVulkan11Properties properties11{};
+        VkPhysicalDeviceVulkan12Properties properties12{};
+        VkPhysicalDeviceFeatures features{};
+        VkPhysicalDeviceVulkan11Features features11{};
+        VkPhysicalDeviceVulkan12Features features12{};
+        VkPhysicalDeviceVulkan13Features features13{};
+        VkPhysicalDeviceMemoryProperties memory{};
+        std::vector<VkQueueFamilyProperties> queueFamilies;
+        std::vector<VkExtensionProperties> extensions;
+    };
+
+    std::vector<VkPhysicalDevice> getPhysicalDevices(VkInstance instance);
+    std::vector<VkExtensionProperties> getDeviceExtensions(VkPhysicalDevice device);
+    DeviceInfo getDeviceInfo(VkPhysicalDevice device, std::uint32_t instanceApiVersion);
+    // Queries every device concurrently on pool; the result keeps enumeration order.
+    std::vector<DeviceInfo> getDevicesInfo(const ProbeInstance& instance, ThreadPool& pool);
+
+    std::string_view deviceTypeToStr(VkPhysicalDeviceType type);
+    std::string versionToStr(std::uint32_t version);
+    // IDs and driver versions, as 0x followed by at least four hex digits.
+    std::string hexToStr(std::uint32_t value);
+
+    void printDeviceProperties(const DeviceInfo& info);
+    void printDeviceFeatures(const DeviceInfo& info);
+    void printDeviceLimits(const DeviceInfo& info);
+    void printDeviceMemory(const DeviceInfo& info);
+    void printDeviceQueues(const DeviceInfo& info);
+    void printDeviceExtensions(const DeviceInfo& info);
+
+    void executeDeviceOptions(const Options& options);
+}
@@ -0,0 +1,196 @@
+#include "dispatch-vk.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace {
+#ifdef _WIN32
+    using LibraryHandle = HMODULE;
+    constexpr std::initializer_list<const char*> systemLibraries{ "vulkan-1.dll" };
+
+    LibraryHandle openLibrary(const char* path) {
+        return LoadLibraryA(path);
+    }
+
+    void* findSymbol(LibraryHandle library, const char* name) {
+        return reinterpret_cast<void*>(GetProcAddress(library, name));
+    }
+
+    void closeLibrary(LibraryHandle library) {
+        FreeLibrary(library);
+    }
+
+    std::string libraryPathOf(void* symbol) {
+        HMODULE module{};
+        if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                static_cast<LPCSTR>(symbol), &module)) {
+            return {};
+        }
+        char path[MAX_PATH];
+        const DWORD size{ GetModuleFileNameA(module, path, MAX_PATH) };
+        return { path, size };
+    }
+#else
+    using LibraryHandle = void*;
+#ifdef __APPLE__
+    constexpr std::initializer_list<const char*> systemLibraries{ "libvulkan.1.dylib", "libvulkan.dylib" };
+#else
+    constexpr std::initializer_list<const char*> systemLibraries{ "libvulkan.so.1", "libvulkan.so" };
+#endif
+
+    LibraryHandle openLibrary(const char* path) {
+        return dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    }
+
+    void* findSymbol(LibraryHandle library, const char* name) {
+        return dlsym(library, name);
+    }
+
+    void closeLibrary(LibraryHandle library) {
+        dlclose(library);
+    }
+
+    std::string libraryPathOf(void* symbol) {
+        Dl_info info{};
+        return dladdr(symbol, &info) != 0 && info.dli_fname != nullptr ? info.dli_fname : "";
+    }
+#endif
+
+    using PFN_negotiateInterfaceVersion = VkResult (VKAPI_PTR*)(std::uint32_t* version);
+    // The ICD interface version show-vk speaks when it stands in for the loader.
+    constexpr std::uint32_t icdInterfaceVersion{ 5 };
+
+    // What a 1.0 loader or an ICD without layers would answer.
+    VKAPI_ATTR VkResult VKAPI_CALL enumerateInstanceVersion10(std::uint32_t* version) {
+        *version = VK_API_VERSION_1_0;
+        return VK_SUCCESS;
+    }
+
+    VKAPI_ATTR VkResult VKAPI_CALL enumerateNoLayers(std::uint32_t* count, VkLayerProperties*) {
+        *count = 0;
+        return VK_SUCCESS;
+    }
+
+    std::string& libraryOverride() {
+        static std::string path{ [] {
+            const char* value{ std::getenv("SHOW_VK_VULKAN_LIBRARY") };
+            return std::string{ value != nullptr ? value : "" };
+        }() };
+        return path;
+    }
+
+    shw::VulkanFunctions& functionTable() {
+        static shw::VulkanFunctions functions;
+        return functions;
+    }
+
+    // Opened once and kept for the life of the process.
+    PFN_vkGetInstanceProcAddr openVulkan() {
+        const std::string& path{ libraryOverride() };
+        LibraryHandle library{};
+        if (!path.empty()) {
+            library = openLibrary(path.c_str());
+        }
+        else {
+            for (const char* name : systemLibraries) {
+                if ((library = openLibrary(name)) != nullptr) {
+                    break;
+                }
+            }
+        }
+        if (library == nullptr) {
+            throw std::runtime_error{ "Cannot load the Vulkan library" + (path.empty() ? std::string{} : ": " + path) };
+        }
+        if (void* getInstanceProcAddr{ findSymbol(library, "vkGetInstanceProcAddr") }) {
+            return reinterpret_cast<PFN_vkGetInstanceProcAddr>(getInstanceProcAddr);
+        }
+        // Not a loader; talk to it as an ICD.
+        void* getInstanceProcAddr{ findSymbol(library, "vk_icdGetInstanceProcAddr") };
+        if (getInstanceProcAddr == nullptr) {
+            throw std::runtime_error{ "Not a Vulkan loader or ICD: " + path };
+        }
+        if (void* negotiate{ findSymbol(library, "vk_icdNegotiateLoaderICDInterfaceVersion") }) {
+            std::uint32_t version{ icdInterfaceVersion };
+            reinterpret_cast<PFN_negotiateInterfaceVersion>(negotiate)(&version);
+        }
+        return reinterpret_cast<PFN_vkGetInstanceProcAddr>(getInstanceProcAddr);
+    }
+
+    shw::VulkanFunctions& loadGlobalFunctions() {
+        shw::VulkanFunctions& functions{ functionTable() };
+        functions.vkGetInstanceProcAddr = openVulkan();
+#define SHW_VK_LOAD_FUNCTION(name) \
+        functions.name = reinterpret_cast<PFN_##name>(functions.vkGetInstanceProcAddr(nullptr, #name));
+        SHW_VK_GLOBAL_FUNCTIONS(SHW_VK_LOAD_FUNCTION)
+#undef SHW_VK_LOAD_FUNCTION
+        if (functions.vkEnumerateInstanceVersion == nullptr) {
+            functions.vkEnumerateInstanceVersion = enumerateInstanceVersion10;
+        }
+        if (functions.vkEnumerateInstanceLayerProperties == nullptr) {
+            functions.vkEnumerateInstanceLayerProperties = enumerateNoLayers;
+        }
+        if (functions.vkEnumerateInstanceExtensionProperties == nullptr || functions.vkCreateInstance == nullptr) {
+            throw std::runtime_error{ "The Vulkan library does not provide vkCreateInstance and vkEnumerateInstanceExtensionProperties" };
+        }
+        return functions;
+    }
+}
+
+void shw::setVulkanLibrary(std::string_view path) {
+    libraryOverride() = path;
+}
+
+std::string_view shw::vulkanLibrary() {
+    return libraryOverride();
+}
+
+std::string shw::loadedVulkanLibrary() {
+    return libraryPathOf(reinterpret_cast<void*>(vulkanFunctions().vkGetInstanceProcAddr));
+}
+
+bool shw::hasSystemVulkanLoader() {
+    for (const char* name : systemLibraries) {
+        if (LibraryHandle library{ openLibrary(name) }) {
+            closeLibrary(library);
+            return true;
+        }
+    }
+    return false;
+}
+
+const shw::VulkanFunctions& shw::vulkanFunctions() {
+    static const VulkanFunctions& functions{ loadGlobalFunctions() };
+    return functions;
+}
+
+void shw::loadInstanceFunctions(VkInstance instance) {
+    const PFN_vkGetInstanceProcAddr getInstanceProcAddr{ vulkanFunctions().vkGetInstanceProcAddr };
+    VulkanFunctions& functions{ functionTable() };
+#define SHW_VK_LOAD_FUNCTION(name) \
+    functions.name = reinterpret_cast<PFN_##name>(getInstanceProcAddr(instance, #name));
+    SHW_VK_INSTANCE_FUNCTIONS(SHW_VK_LOAD_FUNCTION)
+#undef SHW_VK_LOAD_FUNCTION
+}
+
+void shw::loadDeviceFunctions(VkDevice device, DeviceFunctions& functions) {
+    const PFN_vkGetDeviceProcAddr getDeviceProcAddr{ vulkanFunctions().vkGetDeviceProcAddr };
+    if (getDeviceProcAddr == nullptr) {
+        throw std::runtime_error{ "vkGetDeviceProcAddr is not available before loadInstanceFunctions()" };
+    }
+#define SHW_VK_LOAD_FUNCTION(name) \
+    functions.name = reinterpret_cast<PFN_##name>(getDeviceProcAddr(device, #name));
+    SHW_VK_DEVICE_FUNCTIONS(SHW_VK_LOAD_FUNCTION)
+#undef SHW_VK_LOAD_FUNCTION
+}
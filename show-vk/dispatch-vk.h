@@ -0,0 +1,115 @@
+#pragma once
+
+#include "trace-vk.h"
+
+#include <string_view>
+#include <vulkan/vulkan.h>
+
+// Every Vulkan entry point show-vk calls. show-vk is built with
+// VK_NO_PROTOTYPES and never links the loader; the library is opened on the
+// first call and the functions are resolved through vkGetInstanceProcAddr
+// and vkGetDeviceProcAddr. Add new entry points to the matching list.
+
+// Resolved with a null instance as soon as the library is opened.
+#define SHW_VK_GLOBAL_FUNCTIONS(X) \
+    X(vkEnumerateInstanceVersion) \
+    X(vkEnumerateInstanceExtensionProperties) \
+    X(vkEnumerateInstanceLayerProperties) \
+    X(vkCreateInstance)
+
+// Resolved by loadInstanceFunctions() once an instance exists.
+#define SHW_VK_INSTANCE_FUNCTIONS(X) \
+    X(vkDestroyInstance) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceProperties2) \
+    X(vkGetPhysicalDeviceFeatures) \
+    X(vkGetPhysicalDeviceFeatures2) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkGetPhysicalDeviceQueueFamilyProperties) \
+    X(vkGetPhysicalDeviceFormatProperties) \
+    X(vkGetPhysicalDeviceFormatProperties2) \
+    X(vkCreateDevice) \
+    X(vkGetDeviceProcAddr)
+
+// Resolved per device by loadDeviceFunctions(), skipping the loader trampolines.
+#define SHW_VK_DEVICE_FUNCTIONS(X) \
+    X(vkDestroyDevice) \
+    X(vkGetDeviceQueue) \
+    X(vkDeviceWaitIdle) \
+    X(vkAllocateMemory) \
+    X(vkFreeMemory) \
+    X(vkMapMemory) \
+    X(vkUnmapMemory) \
+    X(vkFlushMappedMemoryRanges) \
+    X(vkInvalidateMappedMemoryRanges) \
+    X(vkCreateFence) \
+    X(vkDestroyFence) \
+    X(vkResetFences) \
+    X(vkWaitForFences) \
+    X(vkQueueSubmit) \
+    X(vkCreateCommandPool) \
+    X(vkDestroyCommandPool) \
+    X(vkAllocateCommandBuffers) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkCmdBindPipeline) \
+    X(vkCmdDispatch) \
+    X(vkCmdResetQueryPool) \
+    X(vkCmdWriteTimestamp) \
+    X(vkCreateQueryPool) \
+    X(vkDestroyQueryPool) \
+    X(vkGetQueryPoolResults) \
+    X(vkCreateShaderModule) \
+    X(vkDestroyShaderModule) \
+    X(vkCreatePipelineLayout) \
+    X(vkDestroyPipelineLayout) \
+    X(vkCreateDescriptorSetLayout) \
+    X(vkDestroyDescriptorSetLayout) \
+    X(vkCreateComputePipelines) \
+    X(vkDestroyPipeline) \
+    X(vkCreatePipelineCache) \
+    X(vkDestroyPipelineCache) \
+    X(vkGetPipelineCacheData)
+
+namespace shw {
+#define SHW_VK_DECLARE_FUNCTION(name) PFN_##name name{};
+
+    struct VulkanFunctions {
+        PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr{};
+        SHW_VK_GLOBAL_FUNCTIONS(SHW_VK_DECLARE_FUNCTION)
+        SHW_VK_INSTANCE_FUNCTIONS(SHW_VK_DECLARE_FUNCTION)
+    };
+
+    struct DeviceFunctions {
+        SHW_VK_DEVICE_FUNCTIONS(SHW_VK_DECLARE_FUNCTION)
+    };
+
+#undef SHW_VK_DECLARE_FUNCTION
+
+    // Library to open instead of the system loader: another loader build or an
+    // ICD, which is then called directly (vk_icdGetInstanceProcAddr) without any
+    // layers. Defaults to $SHOW_VK_VULKAN_LIBRARY and has to be set before the
+    // first Vulkan call.
+    void setVulkanLibrary(std::string_view path);
+    // The configured library, empty when the system loader is used.
+    std::string_view vulkanLibrary();
+    // Where the library behind vulkanFunctions() was found, as the OS resolved
+    // it; opens the library if that has not happened yet.
+    std::string loadedVulkanLibrary();
+    // Whether the system loader can be opened, without keeping it open.
+    bool hasSystemVulkanLoader();
+
+    // Opens the library and resolves the global functions on the first call;
+    // throws if the library cannot be opened.
+    const VulkanFunctions& vulkanFunctions();
+    // Resolves the instance functions for instance. The table is process-wide,
+    // which matches show-vk creating one instance at a time.
+    void loadInstanceFunctions(VkInstance instance);
+    void loadDeviceFunctions(VkDevice device, DeviceFunctions& functions);
+}
+
+// Every Vulkan call show-vk makes goes through here, so it can be timed.
+#define SHW_VK_CALL(function, ...) ::shw::tracedCall(#function, ::shw::vulkanFunctions().function, __VA_ARGS__)
+#define SHW_VK_DEVICE_CALL(functions, function, ...) ::shw::tracedCall(#function, (functions).function, __VA_ARGS__)
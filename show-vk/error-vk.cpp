@@ -1,93 +1,35 @@
 #include "error-vk.h"
+#include "table-vk.h"
+#include "vk-tables.h"
 
-#include <iostream>
-#include <sstream>
+#include <cstdio>
 
-std::string shw::resultToStr(VkResult result) {
-    switch (result) {
-    case VK_SUCCESS: return "VK_SUCCESS";
-    case VK_NOT_READY: return "VK_NOT_READY";
-    case VK_TIMEOUT:   return "VK_TIMEOUT";
-    case VK_EVENT_SET: return "VK_EVENT_SET";
-    case VK_EVENT_RESET: return "VK_EVENT_RESET";
-    case VK_INCOMPLETE: return "VK_INCOMPLETE";
-    case VK_ERROR_OUT_OF_HOST_MEMORY: return "VK_ERROR_OUT_OF_HOST_MEMORY";
-    case VK_ERROR_OUT_OF_DEVICE_MEMORY: return "VK_ERROR_OUT_OF_DEVICE_MEMORY";
-    case VK_ERROR_INITIALIZATION_FAILED: return "VK_ERROR_INITIALIZATION_FAILED";
-    case VK_ERROR_DEVICE_LOST: return "VK_ERROR_DEVICE_LOST";
-    case VK_ERROR_MEMORY_MAP_FAILED: return "VK_ERROR_MEMORY_MAP_FAILED";
-    case VK_ERROR_LAYER_NOT_PRESENT: return "VK_ERROR_LAYER_NOT_PRESENT";
-    case VK_ERROR_EXTENSION_NOT_PRESENT: return "VK_ERROR_EXTENSION_NOT_PRESENT";
-    case VK_ERROR_FEATURE_NOT_PRESENT: return "VK_ERROR_FEATURE_NOT_PRESENT";
-    case VK_ERROR_INCOMPATIBLE_DRIVER: return "VK_ERROR_INCOMPATIBLE_DRIVER";
-    case VK_ERROR_TOO_MANY_OBJECTS: return "VK_ERROR_TOO_MANY_OBJECTS";
-    case VK_ERROR_FORMAT_NOT_SUPPORTED: return "VK_ERROR_FORMAT_NOT_SUPPORTED";
-    case VK_ERROR_FRAGMENTED_POOL: return "VK_ERROR_FRAGMENTED_POOL";
-    case VK_ERROR_UNKNOWN: return "VK_ERROR_UNKNOWN";
-        // Provided by VK_VERSION_1_1
-    case VK_ERROR_OUT_OF_POOL_MEMORY: return "VK_ERROR_OUT_OF_POOL_MEMORY";
-        // Provided by VK_VERSION_1_1
-    case VK_ERROR_INVALID_EXTERNAL_HANDLE: return "VK_ERROR_INVALID_EXTERNAL_HANDLE";
-        // Provided by VK_VERSION_1_2
-    case VK_ERROR_FRAGMENTATION: return "VK_ERROR_FRAGMENTATION";
-        // Provided by VK_VERSION_1_2
-    case VK_ERROR_INVALID_OPAQUE_CAPTURE_ADDRESS: return "VK_ERROR_INVALID_OPAQUE_CAPTURE_ADDRESS";
-        // Provided by VK_VERSION_1_3
-    case VK_PIPELINE_COMPILE_REQUIRED: return "VK_PIPELINE_COMPILE_REQUIRED";
-        // Provided by VK_KHR_surface
-    case VK_ERROR_SURFACE_LOST_KHR: return "VK_ERROR_SURFACE_LOST_KHR";
-        // Provided by VK_KHR_surface
-    case VK_ERROR_NATIVE_WINDOW_IN_USE_KHR: return "VK_ERROR_NATIVE_WINDOW_IN_USE_KHR";
-        // Provided by VK_KHR_swapchain
-    case VK_SUBOPTIMAL_KHR: return "VK_SUBOPTIMAL_KHR";
-        // Provided by VK_KHR_swapchain
-    case VK_ERROR_OUT_OF_DATE_KHR: return "VK_ERROR_OUT_OF_DATE_KHR";
-        // Provided by VK_KHR_display_swapchain
-    case VK_ERROR_INCOMPATIBLE_DISPLAY_KHR: return "VK_ERROR_INCOMPATIBLE_DISPLAY_KHR";
-        // Provided by VK_EXT_debug_report
-    case VK_ERROR_VALIDATION_FAILED_EXT: return "VK_ERROR_VALIDATION_FAILED_EXT";
-        // Provided by VK_NV_glsl_shader
-    case VK_ERROR_INVALID_SHADER_NV: return "VK_ERROR_INVALID_SHADER_NV";
-        // Provided by VK_KHR_video_queue
-    case VK_ERROR_IMAGE_USAGE_NOT_SUPPORTED_KHR: return "VK_ERROR_IMAGE_USAGE_NOT_SUPPORTED_KHR";
-        // Provided by VK_KHR_video_queue
-    case VK_ERROR_VIDEO_PICTURE_LAYOUT_NOT_SUPPORTED_KHR: return "VK_ERROR_VIDEO_PICTURE_LAYOUT_NOT_SUPPORTED_KHR";
-        // Provided by VK_KHR_video_queue
-    case VK_ERROR_VIDEO_PROFILE_OPERATION_NOT_SUPPORTED_KHR: return "VK_ERROR_VIDEO_PROFILE_OPERATION_NOT_SUPPORTED_KHR";
-        // Provided by VK_KHR_video_queue
-    case VK_ERROR_VIDEO_PROFILE_FORMAT_NOT_SUPPORTED_KHR: return "VK_ERROR_VIDEO_PROFILE_FORMAT_NOT_SUPPORTED_KHR";
-        // Provided by VK_KHR_video_queue
-    case VK_ERROR_VIDEO_PROFILE_CODEC_NOT_SUPPORTED_KHR: return "VK_ERROR_VIDEO_PROFILE_CODEC_NOT_SUPPORTED_KHR";
-        // Provided by VK_KHR_video_queue
-    case VK_ERROR_VIDEO_STD_VERSION_NOT_SUPPORTED_KHR: return "VK_ERROR_VIDEO_STD_VERSION_NOT_SUPPORTED_KHR";
-        // Provided by VK_EXT_image_drm_format_modifier
-    case VK_ERROR_INVALID_DRM_FORMAT_MODIFIER_PLANE_LAYOUT_EXT: return "VK_ERROR_INVALID_DRM_FORMAT_MODIFIER_PLANE_LAYOUT_EXT";
-        // Provided by VK_KHR_global_priority
-    case VK_ERROR_NOT_PERMITTED_KHR: return "VK_ERROR_NOT_PERMITTED_KHR";
-        // Provided by VK_EXT_full_screen_exclusive
-    case VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT: return "VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT";
-        // Provided by VK_KHR_deferred_host_operations
-    case VK_THREAD_IDLE_KHR: return "VK_THREAD_IDLE_KHR";
-        // Provided by VK_KHR_deferred_host_operations
-    case VK_THREAD_DONE_KHR: return "VK_THREAD_DONE_KHR";
-        // Provided by VK_KHR_deferred_host_operations
-    case VK_OPERATION_DEFERRED_KHR: return "VK_OPERATION_DEFERRED_KHR";
-        // Provided by VK_KHR_deferred_host_operations
-    case VK_OPERATION_NOT_DEFERRED_KHR: return "VK_OPERATION_NOT_DEFERRED_KHR";
-        // Provided by VK_EXT_image_compression_control
-    case VK_ERROR_COMPRESSION_EXHAUSTED_EXT: return "VK_ERROR_COMPRESSION_EXHAUSTED_EXT";
-        // Provided by VK_EXT_shader_object
-    case VK_ERROR_INCOMPATIBLE_SHADER_BINARY_EXT: return "VK_ERROR_INCOMPATIBLE_SHADER_BINARY_EXT";
-    default: return "UNKNOWN_ERROR";
-    }
+std::string_view shw::resultToStr(VkResult result) {
+    const std::string_view name{ vk::enumName(vk::resultNames, result) };
+    return name.empty() ? "UNKNOWN_ERROR" : name;
 }
 
-std::string shw::getError(const std::string& message, VkResult result) {
-    std::ostringstream os{ message };
-    os << ": " << resultToStr(result) << " (" << result << ')';
-    return os.str();
+std::string shw::getError(std::string_view message, VkResult result) {
+    const std::string_view name{ resultToStr(result) };
+    const std::string code{ std::to_string(result) };
+    std::string error;
+    error.reserve(message.size() + name.size() + code.size() + 5);
+    error.append(message).append(": ").append(name).append(" (").append(code).append(")");
+    return error;
 }
 
-void shw::printError(const std::string& message, VkResult result) {
-    std::cout << getError(message, result) << '\n';
+void shw::printError(std::string_view message, VkResult result) {
+    OutputBuffer& out{ output() };
+    if (out.format() != OutputFormat::Text) {
+        // Keep machine readable output parseable; errors go to stderr instead.
+        std::fprintf(stderr, "%s\n", getError(message, result).c_str());
+        return;
+    }
+    CellBuffer code;
+    out.append(message);
+    out.append(": ");
+    out.append(resultToStr(result));
+    out.append(" (");
+    out.append(formatCell(Cell::signedNumber(result), code));
+    out.append(")\n");
 }
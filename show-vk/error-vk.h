@@ -1,10 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vulkan/vulkan.h>
 
 namespace shw {
-    std::string resultToStr(VkResult result);
-    std::string getError(const std::string& message, VkResult result);
-    void printError(const std::string& message, VkResult result);
+    std::string_view resultToStr(VkResult result);
+    std::string getError(std::string_view message, VkResult result);
+    void printError(std::string_view message, VkResult result);
 }
@@ -0,0 +1,241 @@
+#include "format-vk.h"
+#include "device-vk.h"
+#include "dispatch-vk.h"
+#include "error-vk.h"
+#include "instance-vk.h"
+#include "table-vk.h"
+#include "thread-pool.h"
+#include "trace-vk.h"
+#include "vk-tables.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+    constexpr const char* tilingNames[shw::formatTilingCount]{ "linear", "optimal", "buffer" };
+
+    bool hasExtension(const shw::DeviceInfo& info, std::string_view name) {
+        return std::any_of(info.extensions.cbegin(), info.extensions.cend(),
+            [=](const VkExtensionProperties& extension) { return name == extension.extensionName; });
+    }
+
+    // VkFormatProperties3 reports the full 64-bit feature set, including the
+    // storage-without-format bits that VkFormatProperties cannot express.
+    bool hasFormatProperties3(const shw::DeviceInfo& info) {
+        return info.apiVersion >= VK_API_VERSION_1_3
+            || (info.apiVersion >= VK_API_VERSION_1_1 && hasExtension(info, "VK_KHR_format_feature_flags2"));
+    }
+
+    void queryFormat(VkPhysicalDevice device, bool useProperties3, VkFormat format, std::uint64_t* features) {
+        if (useProperties3) {
+            VkFormatProperties3 properties3{};
+            properties3.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3;
+            VkFormatProperties2 properties2{};
+            properties2.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;
+            properties2.pNext = &properties3;
+            SHW_VK_CALL(vkGetPhysicalDeviceFormatProperties2, device, format, &properties2);
+            features[static_cast<std::size_t>(shw::FormatTiling::Linear)] = properties3.linearTilingFeatures;
+            features[static_cast<std::size_t>(shw::FormatTiling::Optimal)] = properties3.optimalTilingFeatures;
+            features[static_cast<std::size_t>(shw::FormatTiling::Buffer)] = properties3.bufferFeatures;
+        }
+        else {
+            VkFormatProperties properties{};
+            SHW_VK_CALL(vkGetPhysicalDeviceFormatProperties, device, format, &properties);
+            features[static_cast<std::size_t>(shw::FormatTiling::Linear)] = properties.linearTilingFeatures;
+            features[static_cast<std::size_t>(shw::FormatTiling::Optimal)] = properties.optimalTilingFeatures;
+            features[static_cast<std::size_t>(shw::FormatTiling::Buffer)] = properties.bufferFeatures;
+        }
+    }
+
+    struct FormatRow {
+        VkFormat format;
+        const std::uint64_t* features;
+    };
+
+    constexpr shw::Column<FormatRow> formatMatrixColumns[]{
+        { "format", "Format", shw::Align::Left, [](const FormatRow& row) { return shw::Cell::str(shw::formatToStr(row.format)); } },
+        { "linear", "Linear", shw::Align::Left, [](const FormatRow& row) {
+            return shw::Cell::hex(row.features[static_cast<std::size_t>(shw::FormatTiling::Linear)]); } },
+        { "optimal", "Optimal", shw::Align::Left, [](const FormatRow& row) {
+            return shw::Cell::hex(row.features[static_cast<std::size_t>(shw::FormatTiling::Optimal)]); } },
+        { "buffer", "Buffer", shw::Align::Left, [](const FormatRow& row) {
+            return shw::Cell::hex(row.features[static_cast<std::size_t>(shw::FormatTiling::Buffer)]); } },
+    };
+
+    constexpr shw::Column<shw::vk::FlagName> featureLegendColumns[]{
+        { "bit", "Bit", shw::Align::Left, [](const shw::vk::FlagName& feature) { return shw::Cell::hex(feature.bit); } },
+        { "feature", "Feature", shw::Align::Left, [](const shw::vk::FlagName& feature) { return shw::Cell::str(feature.name); } },
+    };
+
+    struct FormatQueryRow {
+        VkFormat format;
+        std::uint64_t features;
+    };
+
+    constexpr shw::Column<FormatQueryRow> formatQueryColumns[]{
+        { "format", "Format", shw::Align::Left, [](const FormatQueryRow& row) { return shw::Cell::str(shw::formatToStr(row.format)); } },
+        { "features", "Features", shw::Align::Left, [](const FormatQueryRow& row) { return shw::Cell::hex(row.features); } },
+    };
+}
+
+std::vector<VkFormat> shw::getKnownFormats(const DeviceInfo& info) {
+    std::vector<VkFormat> formats;
+    formats.reserve(std::size(vk::formatNames));
+    // Formats of one extension sit next to each other, so remember the last answer.
+    std::string_view lastExtension;
+    bool lastSupported{};
+    for (const auto& format : vk::formatNames) {
+        if (format.value == VK_FORMAT_UNDEFINED) {
+            continue;
+        }
+        if (info.apiVersion < format.coreVersion) {
+            if (format.extension.empty()) {
+                continue;
+            }
+            if (format.extension != lastExtension) {
+                lastExtension = format.extension;
+                lastSupported = hasExtension(info, format.extension);
+            }
+            if (!lastSupported) {
+                continue;
+            }
+        }
+        formats.push_back(static_cast<VkFormat>(format.value));
+    }
+    return formats;
+}
+
+std::string_view shw::formatToStr(VkFormat format) {
+    const vk::FormatName* entry{ vk::findValue(vk::formatNames, format) };
+    return entry != nullptr ? entry->name : "UNKNOWN_FORMAT";
+}
+
+std::string shw::formatFeaturesToStr(std::uint64_t features) {
+    std::string result;
+    for (const auto& feature : vk::formatFeatureFlagNames) {
+        if (features & feature.bit) {
+            result += result.empty() ? "" : " | ";
+            result += feature.name;
+            features &= ~feature.bit;
+        }
+    }
+    if (features != 0) {
+        result += result.empty() ? "" : " | ";
+        CellBuffer buffer;
+        result += formatCell(Cell::hex(features), buffer);
+    }
+    return result.empty() ? "NONE" : result;
+}
+
+bool shw::parseFormatFeature(std::string_view name, std::uint64_t& bit) {
+    // The generated table spells out VK_FORMAT_FEATURE_2_*; take the 1.0 prefix too.
+    constexpr std::string_view prefix2{ "VK_FORMAT_FEATURE_2_" };
+    constexpr std::string_view prefix{ "VK_FORMAT_FEATURE_" };
+    std::string_view shortName{ name };
+    if (shortName.compare(0, prefix2.size(), prefix2) == 0) {
+        shortName.remove_prefix(prefix2.size());
+    }
+    else if (shortName.compare(0, prefix.size(), prefix) == 0) {
+        shortName.remove_prefix(prefix.size());
+    }
+    for (const auto& feature : vk::formatFeatureFlagNames) {
+        if (shortName == feature.name || shortName == feature.fullName.substr(prefix2.size())) {
+            bit = feature.bit;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool shw::parseFormatTiling(std::string_view name, FormatTiling& tiling) {
+    for (std::size_t i{}; i < formatTilingCount; ++i) {
+        if (name == tilingNames[i]) {
+            tiling = static_cast<FormatTiling>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<shw::FormatMatrix> shw::getFormatMatrices(const std::vector<DeviceInfo>& devices, ThreadPool& pool) {
+    // Small chunks keep every worker busy even when one device has far more
+    // formats to sweep than the others.
+    constexpr std::size_t chunkSize{ 16 };
+    struct Chunk {
+        std::size_t device;
+        std::size_t begin;
+        std::size_t end;
+    };
+    std::vector<FormatMatrix> matrices(devices.size());
+    std::vector<bool> useProperties3(devices.size());
+    std::vector<Chunk> chunks;
+    for (std::size_t d{}, length{ devices.size() }; d < length; ++d) {
+        auto& matrix{ matrices[d] };
+        matrix.formats = getKnownFormats(devices[d]);
+        matrix.features.resize(matrix.formats.size() * formatTilingCount);
+        useProperties3[d] = hasFormatProperties3(devices[d]);
+        for (std::size_t begin{}; begin < matrix.formats.size(); begin += chunkSize) {
+            chunks.push_back({ d, begin, std::min(begin + chunkSize, matrix.formats.size()) });
+        }
+    }
+    pool.parallelFor(chunks.size(), [&](std::size_t i) {
+        const TraceScope scope{ "queryFormats" };
+        const Chunk& chunk{ chunks[i] };
+        auto& matrix{ matrices[chunk.device] };
+        for (std::size_t row{ chunk.begin }; row < chunk.end; ++row) {
+            queryFormat(devices[chunk.device].device, useProperties3[chunk.device], matrix.formats[row],
+                &matrix.features[row * formatTilingCount]);
+        }
+    });
+    return matrices;
+}
+
+std::vector<std::size_t> shw::findFormats(const FormatMatrix& matrix, FormatTiling tiling, std::uint64_t required) {
+    std::vector<std::size_t> rows;
+    for (std::size_t row{}, length{ matrix.formats.size() }; row < length; ++row) {
+        if ((matrix.get(row, tiling) & required) == required) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+void shw::printFormatMatrix(const FormatMatrix& matrix) {
+    std::vector<FormatRow> rows;
+    rows.reserve(matrix.formats.size());
+    for (std::size_t row{}, length{ matrix.formats.size() }; row < length; ++row) {
+        rows.push_back({ matrix.formats[row], &matrix.features[row * formatTilingCount] });
+    }
+    OutputBuffer& out{ output() };
+    renderTable(out, "formats", "Device formats:\n", formatMatrixColumns, rows);
+    renderTable(out, "formatFeatureBits", "Format feature bits:\n", featureLegendColumns, vk::formatFeatureFlagNames, std::size(vk::formatFeatureFlagNames));
+}
+
+shw::FormatQuery shw::parseFormatQuery(const std::vector<std::string_view>& tokens) {
+    FormatQuery query;
+    for (const auto& token : tokens) {
+        std::uint64_t bit{};
+        if (parseFormatTiling(token, query.tiling)) {
+            continue;
+        }
+        if (!parseFormatFeature(token, bit)) {
+            throw std::runtime_error{ "Unknown format feature: " + std::string{ token } };
+        }
+        query.required |= bit;
+    }
+    // Every format has the empty feature set, so a tiling alone would list them all.
+    if (query.required == 0) {
+        throw std::runtime_error{ "Format query names no format feature" };
+    }
+    return query;
+}
+
+void shw::printFormatQuery(const FormatMatrix& matrix, const FormatQuery& query) {
+    std::vector<FormatQueryRow> rows;
+    for (std::size_t row : findFormats(matrix, query.tiling, query.required)) {
+        rows.push_back({ matrix.formats[row], matrix.get(row, query.tiling) });
+    }
+    const std::string title{ "Formats with " + formatFeaturesToStr(query.required) + " ("
+        + tilingNames[static_cast<std::size_t>(query.tiling)] + " tiling):\n" };
+    renderTable(output(), "formatQuery", title, formatQueryColumns, rows);
+}
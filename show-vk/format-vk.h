@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace shw {
+    class ThreadPool;
+    struct DeviceInfo;
+
+    enum class FormatTiling : std::size_t { Linear, Optimal, Buffer };
+    constexpr std::size_t formatTilingCount{ 3 };
+
+    // Format capabilities of one device: one row per format and one 64-bit
+    // feature bitmap per tiling, stored row-major in a single flat array.
+    // Bits follow VkFormatFeatureFlagBits2, a superset of VkFormatFeatureFlagBits.
+    struct FormatMatrix {
+        std::vector<VkFormat> formats;
+        std::vector<std::uint64_t> features;
+
+        std::uint64_t get(std::size_t row, FormatTiling tiling) const {
+            return features[row * formatTilingCount + static_cast<std::size_t>(tiling)];
+        }
+    };
+
+    // Core formats plus the extension formats the device can legally be asked about.
+    std::vector<VkFormat> getKnownFormats(const DeviceInfo& info);
+    std::string_view formatToStr(VkFormat format);
+    std::string formatFeaturesToStr(std::uint64_t features);
+    // Accepts STORAGE_IMAGE as well as VK_FORMAT_FEATURE_[2_]STORAGE_IMAGE_BIT.
+    bool parseFormatFeature(std::string_view name, std::uint64_t& bit);
+    bool parseFormatTiling(std::string_view name, FormatTiling& tiling);
+
+    // Sweeps the formats of every device at once, split in chunks across pool.
+    std::vector<FormatMatrix> getFormatMatrices(const std::vector<DeviceInfo>& devices, ThreadPool& pool);
+    // Rows whose features for tiling include every bit in required.
+    std::vector<std::size_t> findFormats(const FormatMatrix& matrix, FormatTiling tiling, std::uint64_t required);
+
+    struct FormatQuery {
+        FormatTiling tiling{ FormatTiling::Optimal };
+        std::uint64_t required{};
+    };
+
+    // tokens hold at least one feature name and optionally one of
+    // linear/optimal/buffer (default optimal).
+    FormatQuery parseFormatQuery(const std::vector<std::string_view>& tokens);
+
+    void printFormatMatrix(const FormatMatrix& matrix);
+    void printFormatQuery(const FormatMatrix& matrix, const FormatQuery& query);
+}
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""Generates vk-tables.h, the constexpr name tables show-vk prints enums and
+flags with, from the Vulkan registry (vk.xml).
+
+Values are emitted as numbers rather than enumerant names, so a registry
+newer than the vulkan.h being compiled against still builds.
+"""
+
+import argparse
+import os
+import xml.etree.ElementTree as ET
+
+# VkXxx enum -> C++ table name
+ENUMS = {
+    'VkResult': 'resultNames',
+    'VkPhysicalDeviceType': 'physicalDeviceTypeNames',
+}
+
+# VkXxxFlagBits -> (C++ table name, prefix stripped for the short name)
+FLAGS = {
+    'VkFormatFeatureFlagBits2': ('formatFeatureFlagNames', 'VK_FORMAT_FEATURE_2_'),
+    'VkQueueFlagBits': ('queueFlagNames', 'VK_QUEUE_'),
+    'VkMemoryPropertyFlagBits': ('memoryPropertyFlagNames', 'VK_MEMORY_PROPERTY_'),
+    'VkMemoryHeapFlagBits': ('memoryHeapFlagNames', 'VK_MEMORY_HEAP_'),
+}
+
+FORMAT = 'VkFormat'
+NEVER_CORE = 0xFFFFFFFF
+EXTENSION_BASE = 1000000000
+EXTENSION_BLOCK = 1000
+
+
+def for_vulkan(element, attribute='api'):
+    value = element.get(attribute)
+    return value is None or 'vulkan' in value.split(',')
+
+
+def api_version(number):
+    major, minor = (int(part) for part in number.split('.'))
+    return (major << 22) | (minor << 12)
+
+
+def enum_value(enum, extension_number):
+    if 'value' in enum.attrib:
+        return int(enum.get('value'), 0)
+    if 'bitpos' in enum.attrib:
+        return 1 << int(enum.get('bitpos'))
+    if 'offset' in enum.attrib:
+        number = int(enum.get('extnumber', extension_number))
+        value = EXTENSION_BASE + (number - 1) * EXTENSION_BLOCK + int(enum.get('offset'))
+        return -value if enum.get('dir') == '-' else value
+    return None
+
+
+class Registry:
+    def __init__(self, root):
+        wanted = set(ENUMS) | set(FLAGS) | {FORMAT}
+        self.values = {name: {} for name in wanted}
+        # VkFormat name -> [core version, providing extension]
+        self.formats = {}
+
+        for enums in root.findall('enums'):
+            name = enums.get('name')
+            if name not in wanted:
+                continue
+            for enum in enums.findall('enum'):
+                if 'alias' in enum.attrib or not for_vulkan(enum):
+                    continue
+                self.add(name, enum.get('name'), enum_value(enum, None), api_version('1.0'), None)
+
+        for feature in root.findall('feature'):
+            if not for_vulkan(feature):
+                continue
+            version = api_version(feature.get('number'))
+            for enum in feature.iter('enum'):
+                self.add_required(enum, None, version, None)
+
+        extensions = root.find('extensions')
+        for extension in extensions.findall('extension') if extensions is not None else []:
+            if not for_vulkan(extension, 'supported'):
+                continue
+            for require in extension.findall('require'):
+                if not for_vulkan(require):
+                    continue
+                for enum in require.findall('enum'):
+                    self.add_required(enum, extension.get('number'), None, extension.get('name'))
+
+    def add_required(self, enum, extension_number, version, extension):
+        extends = enum.get('extends')
+        if extends not in self.values or not for_vulkan(enum):
+            return
+        alias = enum.get('alias')
+        if alias is not None:
+            # Promoted formats are required by their extension through an alias.
+            if extends == FORMAT and extension is not None:
+                self.formats.setdefault(alias, [NEVER_CORE, None])
+                if self.formats[alias][1] is None:
+                    self.formats[alias][1] = extension
+            return
+        self.add(extends, enum.get('name'), enum_value(enum, extension_number), version, extension)
+
+    def add(self, enum, name, value, version, extension):
+        if value is None:
+            return
+        self.values[enum][name] = value
+        if enum != FORMAT:
+            return
+        origin = self.formats.setdefault(name, [NEVER_CORE, None])
+        if version is not None:
+            origin[0] = min(origin[0], version)
+        if extension is not None and origin[1] is None:
+            origin[1] = extension
+
+
+def short_flag_name(name, prefix):
+    name = name[len(prefix):] if name.startswith(prefix) else name
+    # FOO_BIT -> FOO, FOO_BIT_EXT -> FOO_EXT
+    head, sep, tail = name.rpartition('_BIT')
+    if sep and (tail == '' or (tail.startswith('_') and tail[1:].isalpha() and tail[1:].isupper())):
+        name = head + tail
+    return name
+
+
+def sorted_by_value(values):
+    return sorted(values.items(), key=lambda item: (item[1], item[0]))
+
+
+def generate(registry, source):
+    lines = [
+        '// Generated by gen-vk-tables.py from {}. Do not edit.'.format(os.path.basename(source)),
+        '#pragma once',
+        '',
+        '#include <cstddef>',
+        '#include <cstdint>',
+        '#include <string_view>',
+        '',
+        'namespace shw::vk {',
+        '    struct EnumName {',
+        '        std::int64_t value;',
+        '        std::string_view name;',
+        '    };',
+        '',
+        '    struct FlagName {',
+        '        std::uint64_t bit;',
+        '        // Without the enum prefix and the _BIT part, e.g. GRAPHICS.',
+        '        std::string_view name;',
+        '        std::string_view fullName;',
+        '    };',
+        '',
+        '    // Formats are listed with what makes them legal to query: the core',
+        '    // version that added them (neverCore if none) or the extension.',
+        '    constexpr std::uint32_t neverCore{{ 0x{:X}u }};'.format(NEVER_CORE),
+        '',
+        '    struct FormatName {',
+        '        std::int64_t value;',
+        '        std::string_view name;',
+        '        std::uint32_t coreVersion;',
+        '        std::string_view extension;',
+        '    };',
+        '',
+        '    // Tables are sorted by value; returns an empty view for unknown values.',
+        '    template<typename Entry, std::size_t N>',
+        '    constexpr const Entry* findValue(const Entry (&table)[N], std::int64_t value) {',
+        '        std::size_t first{}, last{ N };',
+        '        while (first < last) {',
+        '            const std::size_t middle{ first + (last - first) / 2 };',
+        '            if (table[middle].value < value) {',
+        '                first = middle + 1;',
+        '            }',
+        '            else {',
+        '                last = middle;',
+        '            }',
+        '        }',
+        '        return first < N && table[first].value == value ? &table[first] : nullptr;',
+        '    }',
+        '',
+        '    template<std::size_t N>',
+        '    constexpr std::string_view enumName(const EnumName (&table)[N], std::int64_t value) {',
+        '        const EnumName* entry{ findValue(table, value) };',
+        '        return entry != nullptr ? entry->name : std::string_view{};',
+        '    }',
+    ]
+
+    for enum, table in ENUMS.items():
+        lines += ['', '    inline constexpr EnumName {}[]{{'.format(table)]
+        for name, value in sorted_by_value(registry.values[enum]):
+            lines.append('        {{ {}, "{}" }},'.format(value, name))
+        lines.append('    };')
+
+    lines += ['', '    inline constexpr FormatName formatNames[]{']
+    for name, value in sorted_by_value(registry.values[FORMAT]):
+        version, extension = registry.formats.get(name, [NEVER_CORE, None])
+        lines.append('        {{ {}, "{}", 0x{:X}u, "{}" }},'.format(value, name, version, extension or ''))
+    lines.append('    };')
+
+    for enum, (table, prefix) in FLAGS.items():
+        lines += ['', '    inline constexpr FlagName {}[]{{'.format(table)]
+        for name, value in sorted_by_value(registry.values[enum]):
+            if value == 0 or value & (value - 1):
+                continue
+            lines.append('        {{ 0x{:X}ull, "{}", "{}" }},'.format(value, short_flag_name(name, prefix), name))
+        lines.append('    };')
+
+    lines += ['}', '']
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--registry', required=True, help='path to vk.xml')
+    parser.add_argument('--output', required=True, help='header to write')
+    args = parser.parse_args()
+
+    registry = Registry(ET.parse(args.registry).getroot())
+    content = generate(registry, args.registry)
+    # Leave the header alone when nothing changed so dependents don't rebuild.
+    if os.path.exists(args.output):
+        with open(args.output, encoding='utf-8') as existing:
+            if existing.read() == content:
+                return
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'w', encoding='utf-8', newline='\n') as output:
+        output.write(content)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,128 @@
+#include "index-vk.h"
+#include "snapshot-vk.h"
+#include "trace-vk.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace {
+    using Entry = shw::NameIndex::Entry;
+
+    // Vulkan name arrays are not guaranteed to be NUL terminated.
+    template<std::size_t N>
+    std::string_view fixedName(const char (&name)[N]) {
+        const void* end{ std::memchr(name, '\0', N) };
+        return { name, end != nullptr ? static_cast<std::size_t>(static_cast<const char*>(end) - name) : N };
+    }
+
+    // Orders loader-provided entries (noLayer) before any layer.
+    std::uint64_t providerRank(std::uint32_t layer) {
+        return layer == shw::NameIndex::noLayer ? 0 : std::uint64_t{ layer } + 1;
+    }
+
+    bool byName(const Entry& lhs, const Entry& rhs) {
+        return std::forward_as_tuple(lhs.name, providerRank(lhs.layer))
+            < std::forward_as_tuple(rhs.name, providerRank(rhs.layer));
+    }
+
+    bool byLayer(const Entry& lhs, const Entry& rhs) {
+        return std::forward_as_tuple(providerRank(lhs.layer), lhs.name)
+            < std::forward_as_tuple(providerRank(rhs.layer), rhs.name);
+    }
+
+    bool startsWith(std::string_view text, std::string_view prefix) {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    // Entries of [first, last) sorted by name whose name equals or starts with query.name.
+    shw::NameIndex::Range findNames(const Entry* first, const Entry* last, const shw::NameQuery& query) {
+        const Entry* begin{ std::lower_bound(first, last, query.name,
+            [](const Entry& entry, std::string_view name) { return entry.name < name; }) };
+        const Entry* end{ query.prefix
+            ? std::partition_point(begin, last, [&](const Entry& entry) { return startsWith(entry.name, query.name); })
+            : std::partition_point(begin, last, [&](const Entry& entry) { return entry.name == query.name; }) };
+        return { begin, end };
+    }
+}
+
+shw::NameQuery shw::parseNameQuery(std::string_view text) {
+    NameQuery query;
+    if (const auto colon{ text.find(':') }; colon != std::string_view::npos) {
+        query.layer = text.substr(0, colon);
+        text.remove_prefix(colon + 1);
+    }
+    if (!text.empty() && text.back() == '*') {
+        query.prefix = true;
+        text.remove_suffix(1);
+    }
+    query.name = text;
+    return query;
+}
+
+shw::NameIndex::NameIndex(const InstanceSnapshot& snapshot) {
+    rebuild(snapshot);
+}
+
+void shw::NameIndex::rebuild(const InstanceSnapshot& snapshot) {
+    const TraceScope scope{ "buildNameIndex" };
+    extensionsByName_.clear();
+    layers_.clear();
+    layerNames_.clear();
+
+    std::size_t extensionCount{ snapshot.extensions.size() };
+    for (const auto& extensions : snapshot.layerExtensions) {
+        extensionCount += extensions.size();
+    }
+    extensionsByName_.reserve(extensionCount);
+    for (const auto& extension : snapshot.extensions) {
+        extensionsByName_.push_back({ fixedName(extension.extensionName), noLayer });
+    }
+    layers_.reserve(snapshot.layers.size());
+    layerNames_.reserve(snapshot.layers.size());
+    for (std::size_t i{}, length{ snapshot.layers.size() }; i < length; ++i) {
+        const auto layer{ static_cast<std::uint32_t>(i) };
+        layers_.push_back({ fixedName(snapshot.layers[i].layerName), layer });
+        layerNames_.push_back(layers_.back().name);
+        if (i < snapshot.layerExtensions.size()) {
+            for (const auto& extension : snapshot.layerExtensions[i]) {
+                extensionsByName_.push_back({ fixedName(extension.extensionName), layer });
+            }
+        }
+    }
+    extensionsByLayer_ = extensionsByName_;
+    std::sort(extensionsByName_.begin(), extensionsByName_.end(), byName);
+    std::sort(extensionsByLayer_.begin(), extensionsByLayer_.end(), byLayer);
+    std::sort(layers_.begin(), layers_.end(), byName);
+}
+
+shw::NameIndex::Range shw::NameIndex::findExtensions(const NameQuery& query) const {
+    const Entry* first{ extensionsByName_.data() };
+    const Entry* last{ first + extensionsByName_.size() };
+    if (query.layer.empty()) {
+        return findNames(first, last, query);
+    }
+    const Range layers{ findLayers({ {}, query.layer }) };
+    if (layers.empty()) {
+        return {};
+    }
+    // The entries of one provider are contiguous and sorted by name.
+    const std::uint32_t layer{ layers.first->layer };
+    first = extensionsByLayer_.data();
+    last = first + extensionsByLayer_.size();
+    const auto rank{ providerRank(layer) };
+    const Entry* begin{ std::partition_point(first, last,
+        [&](const Entry& entry) { return providerRank(entry.layer) < rank; }) };
+    const Entry* end{ std::partition_point(begin, last,
+        [&](const Entry& entry) { return providerRank(entry.layer) == rank; }) };
+    return findNames(begin, end, query);
+}
+
+shw::NameIndex::Range shw::NameIndex::findLayers(const NameQuery& query) const {
+    const Entry* first{ layers_.data() };
+    return findNames(first, first + layers_.size(), query);
+}
+
+std::string_view shw::NameIndex::layerName(std::uint32_t layer) const {
+    return layer < layerNames_.size() ? layerNames_[layer] : std::string_view{};
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace shw {
+    struct InstanceSnapshot;
+
+    // One support query: NAME, a NAME* prefix, optionally scoped to one layer
+    // as LAYER:NAME or LAYER:NAME*.
+    struct NameQuery {
+        std::string_view layer;
+        std::string_view name;
+        bool prefix{};
+    };
+
+    NameQuery parseNameQuery(std::string_view text);
+
+    // Sorted flat index over the names of an InstanceSnapshot. Entries point
+    // into the snapshot's fixed-size name buffers, so the snapshot has to
+    // outlive the index and must not be refreshed underneath it. Built once
+    // per run, after which every lookup is a binary search.
+    class NameIndex {
+    public:
+        // Provider of extensions that come from the loader and ICDs.
+        static constexpr std::uint32_t noLayer{ ~std::uint32_t{} };
+
+        struct Entry {
+            std::string_view name;
+            // Index into snapshot.layers of the providing layer, or noLayer.
+            // For layer entries, the index of the layer itself.
+            std::uint32_t layer;
+        };
+
+        struct Range {
+            const Entry* first{};
+            const Entry* last{};
+
+            const Entry* begin() const { return first; }
+            const Entry* end() const { return last; }
+            bool empty() const { return first == last; }
+        };
+
+        NameIndex() = default;
+        explicit NameIndex(const InstanceSnapshot& snapshot);
+        // Reindexes snapshot, reusing the storage of the previous build.
+        void rebuild(const InstanceSnapshot& snapshot);
+
+        // Every (extension, provider) pair matching query, loader-provided
+        // entries first. Empty when a scoping layer is not present.
+        Range findExtensions(const NameQuery& query) const;
+        Range findLayers(const NameQuery& query) const;
+        std::string_view layerName(std::uint32_t layer) const;
+
+    private:
+        std::vector<Entry> extensionsByName_;
+        // Same entries ordered by provider first, for layer scoped queries.
+        std::vector<Entry> extensionsByLayer_;
+        std::vector<Entry> layers_;
+        // Layer names in snapshot order.
+        std::vector<std::string_view> layerNames_;
+    };
+}
@@ -1,262 +1,185 @@
 #include "instance-vk.h"
+#include "dispatch-vk.h"
 #include "error-vk.h"
+#include "snapshot-vk.h"
+#include "cache-vk.h"
+#include "index-vk.h"
+#include "options-vk.h"
+#include "table-vk.h"
+#include "trace-vk.h"
 
-#include <iostream>
-#include <iomanip>
 #include <stdexcept>
 #include <algorithm>
 #include <cstdint>
-#include <cstring>
-#include <regex>
-#include <unordered_set>
+#include <string_view>
 
-void shw::printInstanceVersion() {
-    std::uint32_t version{};
-    VkResult result{ vkEnumerateInstanceVersion(&version) };
+namespace {
+    using Range = shw::NameIndex::Range;
+
+    constexpr std::string_view loaderProvider{ "loader" };
+
+    // One row per hit of a support query; queries without hits get a single
+    // unsupported row.
+    struct SupportQueryRow {
+        std::string_view query;
+        std::string_view name;
+        std::string_view provider;
+        bool supported;
+    };
+
+    constexpr shw::Column<SupportQueryRow> extensionSupportColumns[]{
+        { "query", "Query", shw::Align::Left, [](const SupportQueryRow& row) { return shw::Cell::str(row.query); } },
+        { "name", "Name", shw::Align::Left, [](const SupportQueryRow& row) { return shw::Cell::str(row.name); } },
+        { "supported", "Supported", shw::Align::Left, [](const SupportQueryRow& row) { return shw::Cell::yesNo(row.supported); } },
+        { "provider", "Provider", shw::Align::Left, [](const SupportQueryRow& row) { return shw::Cell::str(row.provider); } },
+    };
+
+    constexpr shw::Column<SupportQueryRow> layerSupportColumns[]{
+        { "query", "Query", shw::Align::Left, [](const SupportQueryRow& row) { return shw::Cell::str(row.query); } },
+        { "name", "Name", shw::Align::Left, [](const SupportQueryRow& row) { return shw::Cell::str(row.name); } },
+        { "supported", "Supported", shw::Align::Left, [](const SupportQueryRow& row) { return shw::Cell::yesNo(row.supported); } },
+    };
+}
+
+void shw::printInstanceVersion(const InstanceSnapshot& snapshot) {
+    const TraceScope scope{ "printInstanceVersion" };
+    const std::uint32_t version{ snapshot.version };
+    const VkResult result{ snapshot.versionResult };
     if (result == VK_SUCCESS) {
-        std::cout << "Vulkan Instance Version: " << VK_API_VERSION_VARIANT(version)
-            << '.' << VK_API_VERSION_MAJOR(version)
-            << '.' << VK_API_VERSION_MINOR(version)
-            << '.' << VK_API_VERSION_PATCH(version) << '\n';
+        OutputBuffer& out{ output() };
+        writeField(out, "instanceVersion", "Vulkan Instance Version: ", Cell::version(version));
+        endSection(out);
     }
     else {
         printError("vkEnumerateInstanceversion() failed", result);
     }
 }
 
-void shw::printTable(const std::vector<std::string>& header, const std::vector<std::vector<std::string>>& rows) {
-    if (rows.size() > 0 && header.size() != rows[0].size()) {
-        throw std::runtime_error{ "Different number of columns in header and rows!" };
-    }
-    std::vector<std::size_t> offsets(header.size());
-    std::transform(header.cbegin(), header.cend(),
-        offsets.begin(),
-        [](const std::string& columnName) { return columnName.size(); });
-    for (const auto& row : rows) {
-        for (std::size_t i{}, length{ row.size() }; i < length; ++i) {
-            offsets[i] = std::max(offsets[i], row[i].size());
-        }
-    }
-    constexpr std::size_t offsetDelim{ 5 };
-    auto printRow{ [&](const std::vector<std::string>& row) {
-        for (std::size_t i{}, length{row.size() - 1}; i < length; ++i) {
-            std::cout << std::setw(offsets[i]) << row[i] << std::setw(offsetDelim) << ' ';
-        }
-        std::cout << row.back() << '\n';
-    } };
-    printRow(header);
-    for (const auto& row : rows) {
-        printRow(row);
-    }
-}
-
-bool shw::isSupportOption(const std::string& arg, const std::string& supportOption) {
-    return (arg.find(supportOption) == 0) && (arg.size() > supportOption.size())
-        && (arg[supportOption.size()] == '=');
-}
-
-void shw::insertSupportOptionValues(const std::string& arg,
-        const std::string& supportOption,
-        std::unordered_map<std::string, std::vector<std::string>>& supportOptions) {
-    std::regex regex{instanceValuesOptionDelim};
-    std::copy(std::sregex_token_iterator{arg.cbegin() + supportOption.size() + instanceKeyValueOptionDelim.size(),
-                                        arg.cend(),
-                                        regex, -1},
-            std::sregex_token_iterator{},
-            std::back_inserter(supportOptions[supportOption]));
- }
-
-void shw::parseInstanceOption(const std::string& arg,
-        std::unordered_map<std::string, bool>& infoOptions,
-        std::unordered_map<std::string, std::vector<std::string>>& supportOptions) {
-    if (arg == instanceAllOption) {
-        infoOptions[instanceAllOption] = true;
-    } else if (arg == instanceVersionOption) {
-        infoOptions[instanceVersionOption] = true;
-    } else if (arg == instanceShowExtensionsOption) {
-        infoOptions[instanceShowExtensionsOption] = true;
-    } else if (arg == instanceShowLayersOption) {
-        infoOptions[instanceShowLayersOption] = true;
-    } else if (isSupportOption(arg, instanceExtensionsSupportOption)) {
-        insertSupportOptionValues(arg, instanceExtensionsSupportOption, supportOptions);
-    } else if (isSupportOption(arg, instanceLayersSupportOption)) {
-        insertSupportOptionValues(arg, instanceLayersSupportOption, supportOptions);
+void shw::executeInstanceOptions(const Options& options) {
+    auto isSet{ [&](Option option) { return options.isSet(option); } };
+    const bool showAny{ isSet(Option::InstanceAll) || isSet(Option::InstanceVersion)
+        || isSet(Option::InstanceExtensions) || isSet(Option::InstanceLayers) };
+    const bool supportAny{ isSet(Option::InstanceSupportExtensions) || isSet(Option::InstanceSupportLayers) };
+    if (!showAny && !supportAny) {
+        return;
     }
-}
-
-void shw::executeInstanceOptions(const std::unordered_map<std::string, bool>& infoOptions,
-    const std::unordered_map<std::string, std::vector<std::string>>& supportOptions) {
-    if (auto it{infoOptions.find(instanceAllOption)};
-            it != infoOptions.cend() && it->second) {
-        shw::printInstanceVersion();
-        shw::printInstanceExtensions();
-        shw::printInstanceLayers();
+    const InstanceSnapshot snapshot{ isSet(Option::InstanceNoCache) ? takeInstanceSnapshot() : takeCachedInstanceSnapshot() };
+    if (isSet(Option::InstanceAll)) {
+        shw::printInstanceVersion(snapshot);
+        shw::printInstanceExtensions(snapshot);
+        shw::printInstanceLayers(snapshot);
     }
     else {
-        if (auto it{infoOptions.find(instanceVersionOption)};
-                it != infoOptions.cend() && it->second) {
-            shw::printInstanceVersion();
+        if (isSet(Option::InstanceVersion)) {
+            shw::printInstanceVersion(snapshot);
         }
-        if (auto it{infoOptions.find(instanceShowExtensionsOption)};
-                it != infoOptions.cend() && it->second) {
-            shw::printInstanceExtensions();
+        if (isSet(Option::InstanceExtensions)) {
+            shw::printInstanceExtensions(snapshot);
         }
-        if (auto it{ infoOptions.find(instanceShowLayersOption)};
-                it != infoOptions.cend() && it->second) {
-            shw::printInstanceLayers();
+        if (isSet(Option::InstanceLayers)) {
+            shw::printInstanceLayers(snapshot);
         }
     }
-    if (auto it{supportOptions.find(instanceExtensionsSupportOption)};
-            it != supportOptions.cend()) {
-        shw::printInstanceExtensionsSupport(it->second);
-    }
-    if (auto it{supportOptions.find(instanceLayersSupportOption)};
-            it != supportOptions.cend()) {
-        shw::printInstanceLayersSupport(it->second);
-    }
-}
-
-void shw::printTable(const std::vector<std::string>& header, const std::vector<VkExtensionProperties>& extensions) {
-    constexpr std::size_t numExtensionsProperties{ 2 };
-    if (header.size() != numExtensionsProperties) {
-        throw std::runtime_error{ "Invalid number of columns in header! VkExtensionProperties has 2 data members." };
+    if (!supportAny) {
+        return;
     }
-    const std::size_t offsetWidth{ 5 };
-    std::size_t nameWidth{ header[0].size() };
-    std::size_t versionWidth{ header[1].size() };
-    for (const auto& extension : extensions) {
-        nameWidth = std::max(nameWidth, std::strlen(extension.extensionName));
-        versionWidth = std::max(versionWidth, std::to_string(extension.specVersion).size());
+    // One index answers every support query of the run.
+    const NameIndex index{ snapshot };
+    if (isSet(Option::InstanceSupportExtensions)) {
+        shw::printInstanceExtensionsSupport(index, options.values(Option::InstanceSupportExtensions));
     }
-    auto printRow{ [=](const auto& name, const auto& specVersion) {
-        std::cout << '\t' << std::left << std::setw(nameWidth) << name << std::setw(offsetWidth) << " "
-            << std::right << std::setw(versionWidth) << specVersion << '\n';
-    } };
-    printRow(header[0], header[1]);
-    for (const auto& extension : extensions) {
-        printRow(extension.extensionName, extension.specVersion);
+    if (isSet(Option::InstanceSupportLayers)) {
+        shw::printInstanceLayersSupport(index, options.values(Option::InstanceSupportLayers));
     }
 }
 
-std::vector<VkExtensionProperties> shw::getInstanceExtensions() {
+void shw::getInstanceExtensions(const char* layerName, std::vector<VkExtensionProperties>& extensions) {
     std::uint32_t count{};
-    VkResult result{ vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr) };
-    if (result == VK_SUCCESS) {
-        std::vector<VkExtensionProperties> extensions(count);
-        result = vkEnumerateInstanceExtensionProperties(nullptr, &count, extensions.data());
-        if (result == VK_SUCCESS || result == VK_INCOMPLETE) {
-            return extensions;
+    VkResult result{};
+    // The set can grow between the two calls (e.g. a manifest is installed),
+    // in which case the loader reports VK_INCOMPLETE and we ask again.
+    do {
+        result = SHW_VK_CALL(vkEnumerateInstanceExtensionProperties, layerName, &count, nullptr);
+        if (result != VK_SUCCESS) {
+            break;
         }
-        else {
-            throw std::runtime_error{ getError("vkEnumerateInstanceExtensionsProperties() failed", result) };
-        }
-    }
-    else {
+        extensions.resize(count);
+        result = SHW_VK_CALL(vkEnumerateInstanceExtensionProperties, layerName, &count, extensions.data());
+    } while (result == VK_INCOMPLETE);
+    if (result != VK_SUCCESS) {
         throw std::runtime_error{ getError("vkEnumerateInstanceExtensionsProperties() failed", result) };
     }
+    extensions.resize(count);
 }
 
-void shw::printInstanceExtensions() {
-    std::vector<VkExtensionProperties> extensions{ getInstanceExtensions() };
-    const std::vector<std::string> header{ "Name", "Spec Version" };
-    std::cout << "Instance extensions:\n";
-    printTable(header, extensions);
+std::vector<VkExtensionProperties> shw::getInstanceExtensions(const char* layerName) {
+    std::vector<VkExtensionProperties> extensions;
+    getInstanceExtensions(layerName, extensions);
+    return extensions;
 }
 
-void shw::printInstanceExtensionsSupport(const std::vector<std::string>& extensions) {
-    auto availableExtensions{ getInstanceExtensions() };
-    std::unordered_set<std::string> avExts;
-    avExts.reserve(availableExtensions.size());
-    std::transform(availableExtensions.cbegin(), availableExtensions.cend(),
-        std::inserter(avExts, avExts.begin()),
-        [](const auto& extension) { return extension.extensionName;  });
-    std::vector<std::vector<std::string>> rows;
-    rows.reserve(extensions.size());
-    for (const auto& ext : extensions) {
-        std::string isAvailable{ avExts.find(ext) != avExts.end() ? "YES" : "NO" };
-        rows.push_back({ ext, isAvailable });
-    }
-    std::cout << "Instance extensions supported:\n";
-    const std::vector<std::string> header{ "Name", "Supported" };
-    printTable(header, rows);
+void shw::printInstanceExtensions(const InstanceSnapshot& snapshot) {
+    const TraceScope scope{ "printInstanceExtensions" };
+    renderTable(output(), "instanceExtensions", "Instance extensions:\n", extensionColumns, snapshot.extensions);
 }
 
-void shw::printTable(const std::vector<std::string>& header, const std::vector<VkLayerProperties>& layers) {
-    constexpr std::size_t numLayerProperties{ 4 };
-    if (header.size() != numLayerProperties) {
-        throw std::runtime_error{ "Invalid number of columns in header! VkLayerProperties has 4 data members." };
-    }
-    const std::size_t offsetWidth{ 5 };
-    std::size_t nameWidth{ header[0].size() };
-    std::size_t specVersionWidth{ header[1].size() };
-    std::size_t impVersionWidth{ header[2].size() };
-    std::size_t descriptionWidth{ header[3].size() };
-    for (const auto& layer : layers) {
-        nameWidth = std::max(nameWidth, std::strlen(layer.layerName));
-        specVersionWidth = std::max(specVersionWidth, std::to_string(layer.specVersion).size());
-        impVersionWidth = std::max(impVersionWidth, std::to_string(layer.implementationVersion).size());
-        descriptionWidth = std::max(descriptionWidth, std::strlen(layer.description));
-    }
-    auto printRow = [=](const auto& name, const auto& specVersion, const auto& impVersion, const auto& description) {
-        std::cout << '\t' << std::left << std::setw(nameWidth) << name << std::setw(offsetWidth) << " "
-            << std::right << std::setw(specVersionWidth) << specVersion << std::setw(offsetWidth) << " "
-            << std::setw(impVersionWidth) << impVersion << std::setw(offsetWidth) << " "
-            << std::left << std::setw(descriptionWidth) << description << '\n';
-    };
-    printRow(header[0], header[1], header[2], header[3]);
-    for (const auto& layer : layers) {
-        printRow(layer.layerName, layer.specVersion, layer.implementationVersion, layer.description);
+void shw::printInstanceExtensionsSupport(const NameIndex& index, const std::vector<std::string_view>& extensions) {
+    const TraceScope scope{ "printInstanceExtensionsSupport" };
+    std::vector<SupportQueryRow> rows;
+    rows.reserve(extensions.size());
+    for (const auto& ext : extensions) {
+        const Range hits{ index.findExtensions(parseNameQuery(ext)) };
+        if (hits.empty()) {
+            rows.push_back({ ext, {}, {}, false });
+        }
+        for (const auto& hit : hits) {
+            rows.push_back({ ext, hit.name,
+                hit.layer == NameIndex::noLayer ? loaderProvider : index.layerName(hit.layer), true });
+        }
     }
+    renderTable(output(), "instanceExtensionsSupport", "Instance extensions supported:\n", extensionSupportColumns, rows);
 }
 
-std::vector<VkLayerProperties> shw::getInstanceLayers() {
+void shw::getInstanceLayers(std::vector<VkLayerProperties>& layers) {
     std::uint32_t count{};
-    VkResult result{ vkEnumerateInstanceLayerProperties(&count, nullptr) };
-    if (result == VK_SUCCESS) {
-        std::vector<VkLayerProperties> layers(count);
-        result = vkEnumerateInstanceLayerProperties(&count, layers.data());
-        if (result == VK_SUCCESS || result == VK_INCOMPLETE) {
-            return layers;
+    VkResult result{};
+    do {
+        result = SHW_VK_CALL(vkEnumerateInstanceLayerProperties, &count, nullptr);
+        if (result != VK_SUCCESS) {
+            break;
         }
-        else {
-            throw std::runtime_error{ getError("vkEnumerateInstanceLayerProperties() failed", result) };
-        }
-    }
-    else {
+        layers.resize(count);
+        result = SHW_VK_CALL(vkEnumerateInstanceLayerProperties, &count, layers.data());
+    } while (result == VK_INCOMPLETE);
+    if (result != VK_SUCCESS) {
         throw std::runtime_error{ getError("vkEnumerateInstanceLayerProperties() failed", result) };
     }
+    layers.resize(count);
 }
 
-void shw::printInstanceLayers() {
-    std::vector<VkLayerProperties> layers{getInstanceLayers()};
-    const std::vector<std::string> header{"Name", "Spec Version", "Implementatnion Version", "Description"};
-    std::cout << "Instance layers:\n";
-    printTable(header, layers);
+std::vector<VkLayerProperties> shw::getInstanceLayers() {
+    std::vector<VkLayerProperties> layers;
+    getInstanceLayers(layers);
+    return layers;
+}
+
+void shw::printInstanceLayers(const InstanceSnapshot& snapshot) {
+    const TraceScope scope{ "printInstanceLayers" };
+    renderTable(output(), "instanceLayers", "Instance layers:\n", layerColumns, snapshot.layers);
 }
 
-void shw::printInstanceLayersSupport(const std::vector<std::string>& layers) {
-    auto availableLayers{getInstanceLayers()};
-    std::unordered_set<std::string> avLayers;
-    avLayers.reserve(availableLayers.size());
-    std::transform(availableLayers.cbegin(), availableLayers.cend(),
-        std::inserter(avLayers, avLayers.begin()),
-        [](const auto& layer) { return layer.layerName;  });
-    std::vector<std::vector<std::string>> rows;
+void shw::printInstanceLayersSupport(const NameIndex& index, const std::vector<std::string_view>& layers) {
+    const TraceScope scope{ "printInstanceLayersSupport" };
+    std::vector<SupportQueryRow> rows;
     rows.reserve(layers.size());
     for (const auto& layer : layers) {
-        std::string isAvailable{ avLayers.find(layer) != avLayers.end() ? "YES" : "NO" };
-        rows.push_back({ layer, isAvailable });
+        const Range hits{ index.findLayers(parseNameQuery(layer)) };
+        if (hits.empty()) {
+            rows.push_back({ layer, {}, {}, false });
+        }
+        for (const auto& hit : hits) {
+            rows.push_back({ layer, hit.name, {}, true });
+        }
     }
-    std::cout << "Instance layers supported:\n";
-    const std::vector<std::string> header{"Name", "Supported"};
-    printTable(header, rows);
+    renderTable(output(), "instanceLayersSupport", "Instance layers supported:\n", layerSupportColumns, rows);
 }
-
-const std::string shw::instanceAllOption{"--instance-all"};
-const std::string shw::instanceVersionOption{"--instance-version"};
-const std::string shw::instanceShowExtensionsOption{"--instance-extensions"};
-const std::string shw::instanceShowLayersOption{"--instance-layers"};
-const std::string shw::instanceExtensionsSupportOption{"--instance-support-extensions"};
-const std::string shw::instanceLayersSupportOption{"--instance-support-layers"};
-const std::string shw::instanceKeyValueOptionDelim{"="};
-const std::string shw::instanceValuesOptionDelim{","};
@@ -0,0 +1,256 @@
+#include "memory-bench-vk.h"
+#include "bench-vk.h"
+#include "device-vk.h"
+#include "error-vk.h"
+#include "table-vk.h"
+#include "thread-pool.h"
+#include "trace-vk.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+    constexpr std::array<VkDeviceSize, 4> blockSizes{ 4ull << 10, 64ull << 10, 1ull << 20, 16ull << 20 };
+    // Bandwidth runs move about this much per measurement, so small blocks get
+    // more iterations than large ones.
+    constexpr VkDeviceSize bytesPerMeasurement{ 256ull << 20 };
+    constexpr std::size_t minIterations{ 8 };
+    constexpr std::size_t maxIterations{ 1024 };
+    constexpr std::size_t latencyIterations{ 64 };
+    // Below this a slice per thread costs more to hand out than to copy.
+    constexpr VkDeviceSize minSlicePerThread{ 64ull << 10 };
+    // Leave most of a heap to everybody else.
+    constexpr VkDeviceSize maxHeapFraction{ 4 };
+
+    struct MemoryBenchRow {
+        std::uint32_t type;
+        std::uint32_t heap;
+        std::string_view test;
+        VkDeviceSize blockSize;
+        std::size_t threads;
+        shw::BenchStats stats;
+        // Of the median iteration; zero for the latency tests.
+        double bandwidth;
+    };
+
+    constexpr shw::Column<MemoryBenchRow> memoryBenchColumns[]{
+        { "type", "Type", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.type); } },
+        { "heap", "Heap", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.heap); } },
+        { "test", "Test", shw::Align::Left, [](const MemoryBenchRow& row) { return shw::Cell::str(row.test); } },
+        { "blockSize", "Block Size", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.blockSize); } },
+        { "threads", "Threads", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.threads); } },
+        { "samples", "Samples", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.stats.samples); } },
+        { "p50Ns", "p50 ns", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.stats.p50); } },
+        { "p90Ns", "p90 ns", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.stats.p90); } },
+        { "p99Ns", "p99 ns", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.stats.p99); } },
+        { "maxNs", "max ns", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::number(row.stats.max); } },
+        { "gigabytesPerSecond", "GB/s", shw::Align::Right, [](const MemoryBenchRow& row) { return shw::Cell::real(row.bandwidth); } },
+    };
+
+    // The block the bandwidth tests run on, unmapped and freed even when a
+    // measurement throws.
+    struct BlockMemory {
+        BlockMemory(VkDevice device, const shw::DeviceFunctions& functions) : device{ device }, functions{ functions } {}
+        ~BlockMemory() {
+            if (data != nullptr) {
+                SHW_VK_DEVICE_CALL(functions, vkUnmapMemory, device, memory);
+            }
+            SHW_VK_DEVICE_CALL(functions, vkFreeMemory, device, memory, nullptr);
+        }
+
+        BlockMemory(const BlockMemory&) = delete;
+        BlockMemory& operator=(const BlockMemory&) = delete;
+
+        VkDevice device;
+        const shw::DeviceFunctions& functions;
+        VkDeviceMemory memory{};
+        void* data{};
+    };
+
+    class MemoryBench {
+    public:
+        MemoryBench(const shw::DeviceInfo& info, std::vector<MemoryBenchRow>& rows)
+            : device_{ info.device, { 0 } }, functions_{ device_.functions() }, rows_{ rows } {
+            threadCounts_.push_back(1);
+            if (pool_.size() > 1) {
+                threadCounts_.push_back(pool_.size());
+            }
+            // Touch the host side once so page faults stay out of the timings.
+            source_.assign(blockSizes.back(), 0x5a);
+            destination_.assign(blockSizes.back(), 0);
+        }
+
+        void run(std::uint32_t type, const VkMemoryType& memoryType, const VkMemoryHeap& heap) {
+            const shw::TraceScope scope{ "memoryBenchType" };
+            const bool coherent{ (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0 };
+            for (VkDeviceSize size : blockSizes) {
+                if (size > heap.size / maxHeapFraction) {
+                    break;
+                }
+                if (!runBlock(type, memoryType.heapIndex, size, coherent)) {
+                    // Larger blocks will not fit either.
+                    break;
+                }
+            }
+        }
+
+    private:
+        static void check(VkResult result, const char* message) {
+            if (result != VK_SUCCESS) {
+                throw std::runtime_error{ shw::getError(message, result) };
+            }
+        }
+
+        static bool outOfMemory(VkResult result) {
+            return result == VK_ERROR_OUT_OF_HOST_MEMORY || result == VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        VkResult allocate(std::uint32_t type, VkDeviceSize size, VkDeviceMemory& memory) {
+            VkMemoryAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocateInfo.allocationSize = size;
+            allocateInfo.memoryTypeIndex = type;
+            return SHW_VK_DEVICE_CALL(functions_, vkAllocateMemory, device_.get(), &allocateInfo, nullptr, &memory);
+        }
+
+        void release(VkDeviceMemory memory) {
+            SHW_VK_DEVICE_CALL(functions_, vkFreeMemory, device_.get(), memory, nullptr);
+        }
+
+        // Consumes samples, leaving the vector empty for the next test.
+        void addRow(std::uint32_t type, std::uint32_t heap, std::string_view test, VkDeviceSize size, std::size_t threads,
+                std::vector<std::uint64_t>& samples, bool bandwidth) {
+            const shw::BenchStats stats{ shw::summarize(samples) };
+            samples.clear();
+            rows_.push_back({ type, heap, test, size, threads, stats, bandwidth ? shw::gigabytesPerSecond(size, stats.p50) : 0.0 });
+        }
+
+        // Copies size bytes split evenly over threads.
+        void copy(unsigned char* to, const unsigned char* from, VkDeviceSize size, std::size_t threads) {
+            if (threads == 1) {
+                std::memcpy(to, from, static_cast<std::size_t>(size));
+                return;
+            }
+            const VkDeviceSize slice{ size / threads };
+            pool_.parallelFor(threads, [&](std::size_t i) {
+                const VkDeviceSize offset{ slice * i };
+                const VkDeviceSize length{ i + 1 == threads ? size - offset : slice };
+                std::memcpy(to + offset, from + offset, static_cast<std::size_t>(length));
+            });
+        }
+
+        // Returns false when the device runs out of memory for the block; throws on any other failure.
+        bool runBlock(std::uint32_t type, std::uint32_t heap, VkDeviceSize size, bool coherent) {
+            VkDevice device{ device_.get() };
+            std::vector<std::uint64_t> samples;
+            samples.reserve(maxIterations);
+
+            for (std::size_t i{}; i < latencyIterations; ++i) {
+                VkDeviceMemory memory{};
+                const std::uint64_t start{ shw::benchClock() };
+                const VkResult result{ allocate(type, size, memory) };
+                const std::uint64_t end{ shw::benchClock() };
+                if (outOfMemory(result)) {
+                    return false;
+                }
+                check(result, "vkAllocateMemory() failed");
+                release(memory);
+                samples.push_back(end - start);
+            }
+            addRow(type, heap, "allocate", size, 1, samples, false);
+
+            BlockMemory block{ device, functions_ };
+            if (const VkResult result{ allocate(type, size, block.memory) }; result != VK_SUCCESS) {
+                if (outOfMemory(result)) {
+                    return false;
+                }
+                check(result, "vkAllocateMemory() failed");
+            }
+            for (std::size_t i{}; i < latencyIterations; ++i) {
+                void* data{};
+                const std::uint64_t start{ shw::benchClock() };
+                const VkResult result{ SHW_VK_DEVICE_CALL(functions_, vkMapMemory, device, block.memory, 0, VK_WHOLE_SIZE, 0, &data) };
+                const std::uint64_t end{ shw::benchClock() };
+                check(result, "vkMapMemory() failed");
+                SHW_VK_DEVICE_CALL(functions_, vkUnmapMemory, device, block.memory);
+                samples.push_back(end - start);
+            }
+            addRow(type, heap, "map", size, 1, samples, false);
+
+            check(SHW_VK_DEVICE_CALL(functions_, vkMapMemory, device, block.memory, 0, VK_WHOLE_SIZE, 0, &block.data),
+                "vkMapMemory() failed");
+            auto* mapped{ static_cast<unsigned char*>(block.data) };
+            const VkMappedMemoryRange range{ VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, nullptr, block.memory, 0, VK_WHOLE_SIZE };
+            const std::size_t iterations{ std::clamp<std::size_t>(
+                static_cast<std::size_t>(bytesPerMeasurement / size), minIterations, maxIterations) };
+            std::vector<std::uint64_t> syncSamples;
+            syncSamples.reserve(iterations);
+
+            for (std::size_t threads : threadCounts_) {
+                if (threads > 1 && size / threads < minSlicePerThread) {
+                    continue;
+                }
+                for (std::size_t i{}; i < iterations; ++i) {
+                    const std::uint64_t start{ shw::benchClock() };
+                    copy(mapped, source_.data(), size, threads);
+                    const std::uint64_t end{ shw::benchClock() };
+                    samples.push_back(end - start);
+                    // Flushing is one call whatever the thread count, so it is only timed once.
+                    if (!coherent && threads == 1) {
+                        const VkResult result{ SHW_VK_DEVICE_CALL(functions_, vkFlushMappedMemoryRanges, device, 1, &range) };
+                        syncSamples.push_back(shw::benchClock() - end);
+                        check(result, "vkFlushMappedMemoryRanges() failed");
+                    }
+                }
+                addRow(type, heap, "write", size, threads, samples, true);
+                if (!syncSamples.empty()) {
+                    addRow(type, heap, "flush", size, 1, syncSamples, false);
+                }
+
+                for (std::size_t i{}; i < iterations; ++i) {
+                    if (!coherent && threads == 1) {
+                        const std::uint64_t start{ shw::benchClock() };
+                        const VkResult result{ SHW_VK_DEVICE_CALL(functions_, vkInvalidateMappedMemoryRanges, device, 1, &range) };
+                        syncSamples.push_back(shw::benchClock() - start);
+                        check(result, "vkInvalidateMappedMemoryRanges() failed");
+                    }
+                    const std::uint64_t start{ shw::benchClock() };
+                    copy(destination_.data(), mapped, size, threads);
+                    samples.push_back(shw::benchClock() - start);
+                }
+                addRow(type, heap, "read", size, threads, samples, true);
+                if (!syncSamples.empty()) {
+                    addRow(type, heap, "invalidate", size, 1, syncSamples, false);
+                }
+            }
+            return true;
+        }
+
+        shw::BenchDevice device_;
+        const shw::DeviceFunctions& functions_;
+        std::vector<MemoryBenchRow>& rows_;
+        shw::ThreadPool pool_;
+        std::vector<std::size_t> threadCounts_;
+        std::vector<unsigned char> source_;
+        std::vector<unsigned char> destination_;
+    };
+}
+
+void shw::printDeviceMemoryBench(const DeviceInfo& info) {
+    const TraceScope scope{ "printDeviceMemoryBench" };
+    std::vector<MemoryBenchRow> rows;
+    {
+        MemoryBench bench{ info, rows };
+        for (std::uint32_t i{}; i < info.memory.memoryTypeCount; ++i) {
+            const auto& type{ info.memory.memoryTypes[i] };
+            if ((type.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0) {
+                bench.run(i, type, info.memory.memoryHeaps[type.heapIndex]);
+            }
+        }
+    }
+    renderTable(output(), "memoryBench", "Device memory benchmark:\n", memoryBenchColumns, rows);
+}
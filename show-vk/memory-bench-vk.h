@@ -0,0 +1,11 @@
+#pragma once
+
+namespace shw {
+    struct DeviceInfo;
+
+    // --device-memory-bench: allocation and map latency plus sequential
+    // write/read bandwidth for every host-visible memory type of the device,
+    // over several block sizes and thread counts. Non-coherent types also
+    // report their flush and invalidate costs.
+    void printDeviceMemoryBench(const DeviceInfo& info);
+}
@@ -0,0 +1,118 @@
+#include "options-vk.h"
+
+#include <memory>
+#include <stdexcept>
+
+namespace {
+    constexpr char keyValueDelim{ '=' };
+    constexpr char listDelim{ ',' };
+    constexpr char fileListPrefix{ '@' };
+    constexpr std::string_view stdinList{ "-" };
+
+    bool isListSeparator(char c) {
+        return c == listDelim || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    struct FileCloser {
+        void operator()(std::FILE* file) const { std::fclose(file); }
+    };
+
+    void addListItems(shw::Options& options, shw::Option option, std::string_view list) {
+        std::size_t begin{};
+        while (begin <= list.size()) {
+            std::size_t end{ list.find(listDelim, begin) };
+            if (end == std::string_view::npos) {
+                end = list.size();
+            }
+            const std::string_view item{ list.substr(begin, end - begin) };
+            if (item == stdinList) {
+                // stdin is drained by the first read; a second - would silently be empty.
+                if (options.readStdin()) {
+                    throw std::runtime_error{ "The - list source (stdin) can be given only once" };
+                }
+                options.addListValues(option, options.addSource(stdin));
+            }
+            else if (!item.empty() && item.front() == fileListPrefix) {
+                const std::string path{ item.substr(1) };
+                std::unique_ptr<std::FILE, FileCloser> file{ std::fopen(path.c_str(), "rb") };
+                if (!file) {
+                    throw std::runtime_error{ "Cannot open list file: " + path };
+                }
+                options.addListValues(option, options.addSource(file.get()));
+            }
+            else if (!item.empty()) {
+                options.addValue(option, item);
+            }
+            begin = end + 1;
+        }
+    }
+}
+
+std::string_view shw::Options::value(Option option) const {
+    const auto& values{ values_[static_cast<std::size_t>(option)] };
+    return values.empty() ? std::string_view{} : values.back();
+}
+
+std::string_view shw::Options::addSource(std::FILE* file) {
+    readStdin_ = readStdin_ || file == stdin;
+    std::string& source{ sources_.emplace_back() };
+    constexpr std::size_t chunkSize{ 64 * 1024 };
+    std::size_t size{};
+    for (;;) {
+        source.resize(size + chunkSize);
+        const std::size_t read{ std::fread(source.data() + size, 1, chunkSize, file) };
+        size += read;
+        if (read < chunkSize) {
+            break;
+        }
+    }
+    source.resize(size);
+    if (std::ferror(file)) {
+        throw std::runtime_error{ "Failed to read list" };
+    }
+    return source;
+}
+
+void shw::splitList(std::string_view text, std::vector<std::string_view>& items) {
+    std::size_t i{};
+    const std::size_t length{ text.size() };
+    while (i < length) {
+        if (isListSeparator(text[i])) {
+            ++i;
+        }
+        else if (text[i] == '#') {
+            const std::size_t end{ text.find('\n', i) };
+            i = end == std::string_view::npos ? length : end;
+        }
+        else {
+            const std::size_t begin{ i };
+            while (i < length && !isListSeparator(text[i]) && text[i] != '#') {
+                ++i;
+            }
+            items.push_back(text.substr(begin, i - begin));
+        }
+    }
+}
+
+void shw::parseOptions(int argc, const char* const* argv, Options& options) {
+    for (int i{ 1 }; i < argc; ++i) {
+        const std::string_view arg{ argv[i] };
+        const std::size_t delim{ arg.find(keyValueDelim) };
+        const OptionSpec* spec{ findOption(arg.substr(0, delim)) };
+        if (spec == nullptr) {
+            continue;
+        }
+        const bool hasValue{ delim != std::string_view::npos };
+        // Flags take no value and value options need one; anything else is ignored.
+        if (hasValue != (spec->argument != OptionArgument::None)) {
+            continue;
+        }
+        options.set(spec->option);
+        if (spec->argument == OptionArgument::Value) {
+            options.addValue(spec->option, arg.substr(delim + 1));
+        }
+        else if (spec->argument == OptionArgument::List) {
+            addListItems(options, spec->option, arg.substr(delim + 1));
+        }
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace shw {
+    enum class Option : std::size_t {
+        InstanceAll,
+        InstanceVersion,
+        InstanceExtensions,
+        InstanceLayers,
+        InstanceNoCache,
+        InstanceSupportExtensions,
+        InstanceSupportLayers,
+        DeviceAll,
+        DeviceProperties,
+        DeviceFeatures,
+        DeviceLimits,
+        DeviceMemory,
+        DeviceQueues,
+        DeviceExtensions,
+        DeviceFormats,
+        DeviceFormatsQuery,
+        DeviceMemoryBench,
+        DeviceQueueBench,
+        DevicePipelineBench,
+        DevicePipelineThreads,
+        Format,
+        Trace,
+        VulkanLibrary,
+        Configs,
+        ProbeWorker,
+        Baseline,
+        BaselineSave,
+        BaselineQuiet,
+        Count
+    };
+
+    constexpr std::size_t optionCount{ static_cast<std::size_t>(Option::Count) };
+
+    enum class OptionArgument {
+        None,   // --name
+        Value,  // --name=value
+        List,   // --name=a,b,... where an item may also be @file or - (stdin)
+    };
+
+    struct OptionSpec {
+        Option option;
+        std::string_view name;
+        OptionArgument argument;
+    };
+
+    inline constexpr OptionSpec optionTable[]{
+        { Option::InstanceAll, "--instance-all", OptionArgument::None },
+        { Option::InstanceVersion, "--instance-version", OptionArgument::None },
+        { Option::InstanceExtensions, "--instance-extensions", OptionArgument::None },
+        { Option::InstanceLayers, "--instance-layers", OptionArgument::None },
+        { Option::InstanceNoCache, "--instance-no-cache", OptionArgument::None },
+        { Option::InstanceSupportExtensions, "--instance-support-extensions", OptionArgument::List },
+        { Option::InstanceSupportLayers, "--instance-support-layers", OptionArgument::List },
+        { Option::DeviceAll, "--device-all", OptionArgument::None },
+        { Option::DeviceProperties, "--device-properties", OptionArgument::None },
+        { Option::DeviceFeatures, "--device-features", OptionArgument::None },
+        { Option::DeviceLimits, "--device-limits", OptionArgument::None },
+        { Option::DeviceMemory, "--device-memory", OptionArgument::None },
+        { Option::DeviceQueues, "--device-queues", OptionArgument::None },
+        { Option::DeviceExtensions, "--device-extensions", OptionArgument::None },
+        // The format matrix is hundreds of rows per device, so --device-all leaves it out.
+        { Option::DeviceFormats, "--device-formats", OptionArgument::None },
+        { Option::DeviceFormatsQuery, "--device-formats-query", OptionArgument::List },
+        // Benchmarks take seconds per device and are never part of --device-all.
+        { Option::DeviceMemoryBench, "--device-memory-bench", OptionArgument::None },
+        { Option::DeviceQueueBench, "--device-queue-bench", OptionArgument::None },
+        { Option::DevicePipelineBench, "--device-pipeline-bench", OptionArgument::None },
+        // Also creates pipelines on 1, 2, 4 ... N threads for --device-pipeline-bench.
+        { Option::DevicePipelineThreads, "--device-pipeline-threads", OptionArgument::Value },
+        { Option::Format, "--format", OptionArgument::Value },
+        { Option::Trace, "--trace", OptionArgument::Value },
+        // A loader or ICD library to use instead of the system loader.
+        { Option::VulkanLibrary, "--vulkan-library", OptionArgument::Value },
+        { Option::Configs, "--configs", OptionArgument::Value },
+        // Internal: how --configs starts its worker processes.
+        { Option::ProbeWorker, "--probe-worker", OptionArgument::None },
+        { Option::Baseline, "--baseline", OptionArgument::Value },
+        { Option::BaselineSave, "--baseline-save", OptionArgument::Value },
+        // --baseline prints no report; only the exit code tells whether anything changed.
+        { Option::BaselineQuiet, "--baseline-quiet", OptionArgument::None },
+    };
+
+    constexpr const OptionSpec* findOption(std::string_view name) {
+        for (const auto& spec : optionTable) {
+            if (spec.name == name) {
+                return &spec;
+            }
+        }
+        return nullptr;
+    }
+
+    constexpr std::string_view optionName(Option option) {
+        for (const auto& spec : optionTable) {
+            if (spec.option == option) {
+                return spec.name;
+            }
+        }
+        return {};
+    }
+
+    // Appends the items of a requirements list: entries are separated by commas
+    // or whitespace and # starts a comment that runs to the end of the line.
+    void splitList(std::string_view text, std::vector<std::string_view>& items);
+
+    // Parsed command line. Values are views into argv or into the contents of
+    // the @file and stdin lists, which the Options object keeps alive.
+    class Options {
+    public:
+        Options() = default;
+        Options(const Options&) = delete;
+        Options& operator=(const Options&) = delete;
+
+        bool isSet(Option option) const { return set_[static_cast<std::size_t>(option)]; }
+        const std::vector<std::string_view>& values(Option option) const { return values_[static_cast<std::size_t>(option)]; }
+        // Last value given to a Value option, empty if it was not given.
+        std::string_view value(Option option) const;
+
+        void set(Option option) { set_[static_cast<std::size_t>(option)] = true; }
+        void addValue(Option option, std::string_view value) { values_[static_cast<std::size_t>(option)].push_back(value); }
+        void addListValues(Option option, std::string_view list) { splitList(list, values_[static_cast<std::size_t>(option)]); }
+        // Reads a whole list source and returns a view that stays valid as long as this object.
+        std::string_view addSource(std::FILE* file);
+        // Whether addSource() has already consumed stdin.
+        bool readStdin() const { return readStdin_; }
+
+    private:
+        std::array<bool, optionCount> set_{};
+        std::array<std::vector<std::string_view>, optionCount> values_;
+        // A deque never moves its elements, so views into them stay valid.
+        std::deque<std::string> sources_;
+        bool readStdin_{};
+    };
+
+    // Unknown arguments are ignored, as before. argv[0] is skipped.
+    void parseOptions(int argc, const char* const* argv, Options& options);
+}
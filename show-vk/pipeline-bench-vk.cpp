@@ -0,0 +1,380 @@
+#include "pipeline-bench-vk.h"
+#include "bench-vk.h"
+#include "device-vk.h"
+#include "error-vk.h"
+#include "spirv-vk.h"
+#include "table-vk.h"
+#include "thread-pool.h"
+#include "trace-vk.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+    struct BundledShader {
+        std::uint32_t localSize;
+        std::uint32_t rounds;
+    };
+
+    // From trivial to a few hundred dependent instructions, at two workgroup
+    // sizes. 128 is the least maxComputeWorkGroupSize[0] and
+    // maxComputeWorkGroupInvocations a device may report.
+    constexpr BundledShader bundledShaders[]{
+        { 64, 1 }, { 64, 4 }, { 64, 16 }, { 64, 64 },
+        { 128, 1 }, { 128, 4 }, { 128, 16 }, { 128, 64 },
+    };
+    constexpr std::size_t bundledShaderCount{ std::size(bundledShaders) };
+    // The scaling runs create this many salted copies of the set, so that
+    // every thread count has enough pipelines to share out.
+    constexpr std::size_t scalingCopies{ 8 };
+
+    // The workgroup size the shader is built with on a device with these limits.
+    std::uint32_t localSizeFor(const BundledShader& shader, const VkPhysicalDeviceLimits& limits) {
+        return std::min({ shader.localSize, limits.maxComputeWorkGroupSize[0], limits.maxComputeWorkGroupInvocations });
+    }
+
+    struct PipelineRow {
+        std::size_t shader;
+        std::uint32_t localSize;
+        std::uint64_t coldNs;
+        std::uint64_t noCacheNs;
+        std::uint64_t warmNs;
+        std::uint64_t diskNs;
+    };
+
+    constexpr shw::Column<PipelineRow> pipelineColumns[]{
+        { "shader", "Shader", shw::Align::Right, [](const PipelineRow& row) { return shw::Cell::number(row.shader); } },
+        { "localSize", "Local Size", shw::Align::Right, [](const PipelineRow& row) { return shw::Cell::number(row.localSize); } },
+        { "rounds", "Rounds", shw::Align::Right, [](const PipelineRow& row) { return shw::Cell::number(bundledShaders[row.shader].rounds); } },
+        { "coldNs", "Cold ns", shw::Align::Right, [](const PipelineRow& row) { return shw::Cell::number(row.coldNs); } },
+        { "noCacheNs", "No Cache ns", shw::Align::Right, [](const PipelineRow& row) { return shw::Cell::number(row.noCacheNs); } },
+        { "warmNs", "Warm ns", shw::Align::Right, [](const PipelineRow& row) { return shw::Cell::number(row.warmNs); } },
+        { "diskNs", "Disk ns", shw::Align::Right, [](const PipelineRow& row) { return shw::Cell::number(row.diskNs); } },
+    };
+
+    struct PassRow {
+        std::string_view pass;
+        std::uint64_t totalNs;
+        shw::BenchStats stats;
+        // Cold total over this total.
+        double speedup;
+    };
+
+    constexpr shw::Column<PassRow> passColumns[]{
+        { "pass", "Pass", shw::Align::Left, [](const PassRow& row) { return shw::Cell::str(row.pass); } },
+        { "pipelines", "Pipelines", shw::Align::Right, [](const PassRow& row) { return shw::Cell::number(row.stats.samples); } },
+        { "totalNs", "Total ns", shw::Align::Right, [](const PassRow& row) { return shw::Cell::number(row.totalNs); } },
+        { "p50Ns", "p50 ns", shw::Align::Right, [](const PassRow& row) { return shw::Cell::number(row.stats.p50); } },
+        { "maxNs", "max ns", shw::Align::Right, [](const PassRow& row) { return shw::Cell::number(row.stats.max); } },
+        { "speedup", "Speedup", shw::Align::Right, [](const PassRow& row) { return shw::Cell::real(row.speedup); } },
+    };
+
+    struct ScalingRow {
+        std::size_t threads;
+        std::size_t pipelines;
+        std::uint64_t wallNs;
+        double pipelinesPerSecond;
+        // Single-thread wall time over this one.
+        double speedup;
+    };
+
+    constexpr shw::Column<ScalingRow> scalingColumns[]{
+        { "threads", "Threads", shw::Align::Right, [](const ScalingRow& row) { return shw::Cell::number(row.threads); } },
+        { "pipelines", "Pipelines", shw::Align::Right, [](const ScalingRow& row) { return shw::Cell::number(row.pipelines); } },
+        { "wallNs", "Wall ns", shw::Align::Right, [](const ScalingRow& row) { return shw::Cell::number(row.wallNs); } },
+        { "pipelinesPerSecond", "Pipelines/s", shw::Align::Right, [](const ScalingRow& row) { return shw::Cell::real(row.pipelinesPerSecond); } },
+        { "speedup", "Speedup", shw::Align::Right, [](const ScalingRow& row) { return shw::Cell::real(row.speedup); } },
+    };
+
+    // What the serialized cache says about itself, checked against the device.
+    struct CacheHeaderCheck {
+        std::size_t blobSize{};
+        std::uint32_t headerVersion{};
+        bool idsMatch{};
+        bool uuidMatches{};
+    };
+
+    CacheHeaderCheck checkCacheHeader(const std::vector<unsigned char>& blob, const VkPhysicalDeviceProperties& properties) {
+        CacheHeaderCheck check;
+        check.blobSize = blob.size();
+        VkPipelineCacheHeaderVersionOne header{};
+        if (blob.size() < sizeof(header)) {
+            return check;
+        }
+        std::memcpy(&header, blob.data(), sizeof(header));
+        check.headerVersion = static_cast<std::uint32_t>(header.headerVersion);
+        if (header.headerSize < sizeof(header) || header.headerSize > blob.size()
+                || header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+            return check;
+        }
+        check.idsMatch = header.vendorID == properties.vendorID && header.deviceID == properties.deviceID;
+        check.uuidMatches = std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        return check;
+    }
+
+    // Writes blob to an anonymous temporary file and reads it back, the way a
+    // service would between runs.
+    std::vector<unsigned char> roundTripThroughFile(const std::vector<unsigned char>& blob) {
+        const std::unique_ptr<std::FILE, int (*)(std::FILE*)> file{ std::tmpfile(), &std::fclose };
+        if (!file || std::fwrite(blob.data(), 1, blob.size(), file.get()) != blob.size() || std::fflush(file.get()) != 0) {
+            throw std::runtime_error{ "Cannot write the pipeline cache to a temporary file" };
+        }
+        std::rewind(file.get());
+        std::vector<unsigned char> loaded(blob.size());
+        if (std::fread(loaded.data(), 1, loaded.size(), file.get()) != loaded.size()) {
+            throw std::runtime_error{ "Cannot read the pipeline cache back from a temporary file" };
+        }
+        return loaded;
+    }
+
+    void check(VkResult result, const char* message) {
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error{ shw::getError(message, result) };
+        }
+    }
+
+    // Shader modules for salted copies of the bundled set, destroyed with it.
+    struct ShaderSet {
+        ShaderSet(VkDevice device, const shw::DeviceFunctions& functions) : device{ device }, functions{ functions } {}
+        ~ShaderSet() {
+            for (VkShaderModule module : modules) {
+                SHW_VK_DEVICE_CALL(functions, vkDestroyShaderModule, device, module, nullptr);
+            }
+        }
+
+        ShaderSet(const ShaderSet&) = delete;
+        ShaderSet& operator=(const ShaderSet&) = delete;
+
+        VkDevice device;
+        const shw::DeviceFunctions& functions;
+        std::vector<VkShaderModule> modules;
+    };
+
+    struct PipelineCache {
+        PipelineCache(VkDevice device, const shw::DeviceFunctions& functions) : device{ device }, functions{ functions } {}
+        ~PipelineCache() {
+            SHW_VK_DEVICE_CALL(functions, vkDestroyPipelineCache, device, cache, nullptr);
+        }
+
+        PipelineCache(const PipelineCache&) = delete;
+        PipelineCache& operator=(const PipelineCache&) = delete;
+
+        VkDevice device;
+        const shw::DeviceFunctions& functions;
+        VkPipelineCache cache{};
+    };
+
+    class PipelineBench {
+    public:
+        explicit PipelineBench(const shw::DeviceInfo& info)
+            : device_{ info.device, { 0 } }, functions_{ device_.functions() }, limits_{ info.properties.limits },
+            // Salts only have to differ between runs, not be unpredictable.
+            nextSalt_{ static_cast<std::uint32_t>(shw::benchClock()) } {
+        }
+
+        ~PipelineBench() {
+            SHW_VK_DEVICE_CALL(functions_, vkDestroyPipelineLayout, device_.get(), layout_, nullptr);
+            SHW_VK_DEVICE_CALL(functions_, vkDestroyDescriptorSetLayout, device_.get(), setLayout_, nullptr);
+        }
+
+        PipelineBench(const PipelineBench&) = delete;
+        PipelineBench& operator=(const PipelineBench&) = delete;
+
+        void createLayout() {
+            VkDescriptorSetLayoutBinding binding{};
+            binding.binding = 0;
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            binding.descriptorCount = 1;
+            binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+            setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            setLayoutInfo.bindingCount = 1;
+            setLayoutInfo.pBindings = &binding;
+            check(SHW_VK_DEVICE_CALL(functions_, vkCreateDescriptorSetLayout, device_.get(), &setLayoutInfo, nullptr, &setLayout_),
+                "vkCreateDescriptorSetLayout() failed");
+
+            VkPipelineLayoutCreateInfo layoutInfo{};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            layoutInfo.setLayoutCount = 1;
+            layoutInfo.pSetLayouts = &setLayout_;
+            check(SHW_VK_DEVICE_CALL(functions_, vkCreatePipelineLayout, device_.get(), &layoutInfo, nullptr, &layout_),
+                "vkCreatePipelineLayout() failed");
+        }
+
+        // Module i % bundledShaderCount of the result is that bundled shader.
+        void createShaders(std::size_t copies, ShaderSet& shaders) {
+            shaders.modules.reserve(copies * bundledShaderCount);
+            for (std::size_t copy{}; copy < copies; ++copy) {
+                const std::uint32_t salt{ nextSalt_++ };
+                for (const BundledShader& shader : bundledShaders) {
+                    const std::vector<std::uint32_t> code{ shw::buildXorshiftShader(localSizeFor(shader, limits_), shader.rounds, salt) };
+                    VkShaderModuleCreateInfo shaderInfo{};
+                    shaderInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+                    shaderInfo.codeSize = code.size() * sizeof(code[0]);
+                    shaderInfo.pCode = code.data();
+                    VkShaderModule module{};
+                    check(SHW_VK_DEVICE_CALL(functions_, vkCreateShaderModule, device_.get(), &shaderInfo, nullptr, &module),
+                        "vkCreateShaderModule() failed");
+                    shaders.modules.push_back(module);
+                }
+            }
+        }
+
+        void createCache(const std::vector<unsigned char>& initialData, PipelineCache& cache) {
+            VkPipelineCacheCreateInfo cacheInfo{};
+            cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            cacheInfo.initialDataSize = initialData.size();
+            cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+            check(SHW_VK_DEVICE_CALL(functions_, vkCreatePipelineCache, device_.get(), &cacheInfo, nullptr, &cache.cache),
+                "vkCreatePipelineCache() failed");
+        }
+
+        std::vector<unsigned char> cacheData(const PipelineCache& cache) {
+            std::vector<unsigned char> data;
+            VkResult result{};
+            // The cache cannot grow between the two calls, but VK_INCOMPLETE is retried anyway.
+            do {
+                std::size_t size{};
+                check(SHW_VK_DEVICE_CALL(functions_, vkGetPipelineCacheData, device_.get(), cache.cache, &size, nullptr),
+                    "vkGetPipelineCacheData() failed");
+                data.resize(size);
+                result = SHW_VK_DEVICE_CALL(functions_, vkGetPipelineCacheData, device_.get(), cache.cache, &size, data.data());
+                data.resize(size);
+            } while (result == VK_INCOMPLETE);
+            check(result, "vkGetPipelineCacheData() failed");
+            return data;
+        }
+
+        // Creates and destroys one pipeline; returns how long creating it took.
+        std::uint64_t timePipeline(VkShaderModule module, VkPipelineCache cache) {
+            VkComputePipelineCreateInfo pipelineInfo{};
+            pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            pipelineInfo.stage.module = module;
+            pipelineInfo.stage.pName = "main";
+            pipelineInfo.layout = layout_;
+            VkPipeline pipeline{};
+            const std::uint64_t start{ shw::benchClock() };
+            const VkResult result{ SHW_VK_DEVICE_CALL(functions_, vkCreateComputePipelines, device_.get(), cache, 1, &pipelineInfo, nullptr, &pipeline) };
+            const std::uint64_t end{ shw::benchClock() };
+            check(result, "vkCreateComputePipelines() failed");
+            SHW_VK_DEVICE_CALL(functions_, vkDestroyPipeline, device_.get(), pipeline, nullptr);
+            return end - start;
+        }
+
+        void timePass(const ShaderSet& shaders, VkPipelineCache cache, std::uint64_t PipelineRow::*field, std::vector<PipelineRow>& rows) {
+            const shw::TraceScope scope{ "pipelineBenchPass" };
+            for (std::size_t i{}; i < rows.size(); ++i) {
+                rows[i].*field = timePipeline(shaders.modules[i], cache);
+            }
+        }
+
+        // Wall time to create every pipeline of shaders, without a cache, on threads threads.
+        std::uint64_t timeParallel(const ShaderSet& shaders, std::size_t threads) {
+            const shw::TraceScope scope{ "pipelineBenchParallel" };
+            shw::ThreadPool pool{ threads };
+            const std::uint64_t start{ shw::benchClock() };
+            pool.parallelFor(shaders.modules.size(), [&](std::size_t i) { timePipeline(shaders.modules[i], VK_NULL_HANDLE); });
+            return shw::benchClock() - start;
+        }
+
+        VkDevice device() const { return device_.get(); }
+        const shw::DeviceFunctions& functions() const { return functions_; }
+
+    private:
+        shw::BenchDevice device_;
+        const shw::DeviceFunctions& functions_;
+        const VkPhysicalDeviceLimits& limits_;
+        std::uint32_t nextSalt_;
+        VkDescriptorSetLayout setLayout_{};
+        VkPipelineLayout layout_{};
+    };
+
+    PassRow summarizePass(std::string_view pass, const std::vector<PipelineRow>& rows, std::uint64_t PipelineRow::*field, std::uint64_t coldTotal) {
+        std::vector<std::uint64_t> samples;
+        samples.reserve(rows.size());
+        std::uint64_t total{};
+        for (const PipelineRow& row : rows) {
+            samples.push_back(row.*field);
+            total += row.*field;
+        }
+        const double speedup{ total > 0 ? static_cast<double>(coldTotal) / static_cast<double>(total) : 0.0 };
+        return { pass, total, shw::summarize(samples), speedup };
+    }
+}
+
+void shw::printDevicePipelineBench(const DeviceInfo& info, std::size_t maxThreads) {
+    const TraceScope scope{ "printDevicePipelineBench" };
+    std::vector<PipelineRow> rows(bundledShaderCount);
+    for (std::size_t i{}; i < rows.size(); ++i) {
+        rows[i].shader = i;
+        rows[i].localSize = localSizeFor(bundledShaders[i], info.properties.limits);
+    }
+    std::vector<ScalingRow> scaling;
+    std::vector<unsigned char> blob;
+    {
+        PipelineBench bench{ info };
+        bench.createLayout();
+        {
+            ShaderSet shaders{ bench.device(), bench.functions() };
+            bench.createShaders(1, shaders);
+            PipelineCache cache{ bench.device(), bench.functions() };
+            bench.createCache({}, cache);
+            bench.timePass(shaders, cache.cache, &PipelineRow::coldNs, rows);
+            // Shows what the driver caches on its own, without being handed a VkPipelineCache.
+            bench.timePass(shaders, VK_NULL_HANDLE, &PipelineRow::noCacheNs, rows);
+            bench.timePass(shaders, cache.cache, &PipelineRow::warmNs, rows);
+
+            blob = bench.cacheData(cache);
+            PipelineCache diskCache{ bench.device(), bench.functions() };
+            bench.createCache(roundTripThroughFile(blob), diskCache);
+            bench.timePass(shaders, diskCache.cache, &PipelineRow::diskNs, rows);
+        }
+
+        std::uint64_t singleThreadNs{};
+        for (std::size_t threads{ 1 }; maxThreads > 0; threads = std::min(threads * 2, maxThreads)) {
+            // Fresh copies every time, so no run is warmed up by the one before.
+            ShaderSet shaders{ bench.device(), bench.functions() };
+            bench.createShaders(scalingCopies, shaders);
+            const std::uint64_t wallNs{ bench.timeParallel(shaders, threads) };
+            if (threads == 1) {
+                singleThreadNs = wallNs;
+            }
+            const std::size_t pipelines{ shaders.modules.size() };
+            scaling.push_back({ threads, pipelines, wallNs,
+                wallNs > 0 ? pipelines * 1e9 / static_cast<double>(wallNs) : 0.0,
+                wallNs > 0 ? static_cast<double>(singleThreadNs) / static_cast<double>(wallNs) : 0.0 });
+            if (threads == maxThreads) {
+                break;
+            }
+        }
+    }
+
+    OutputBuffer& out{ output() };
+    renderTable(out, "pipelineBench", "Pipeline creation:\n", pipelineColumns, rows);
+    const PassRow cold{ summarizePass("cold", rows, &PipelineRow::coldNs, 0) };
+    const PassRow passes[]{
+        { cold.pass, cold.totalNs, cold.stats, 1.0 },
+        summarizePass("noCache", rows, &PipelineRow::noCacheNs, cold.totalNs),
+        summarizePass("warm", rows, &PipelineRow::warmNs, cold.totalNs),
+        summarizePass("disk", rows, &PipelineRow::diskNs, cold.totalNs),
+    };
+    renderTable(out, "pipelineBenchPasses", "Pipeline creation passes:\n", passColumns, passes, std::size(passes));
+
+    const CacheHeaderCheck header{ checkCacheHeader(blob, info.properties) };
+    writeField(out, "pipelineCacheSize", "Pipeline cache size: ", Cell::number(header.blobSize));
+    writeField(out, "pipelineCacheHeaderVersion", "Pipeline cache header version: ", Cell::number(header.headerVersion));
+    writeField(out, "pipelineCacheIdsMatch", "Pipeline cache vendor and device IDs match: ", Cell::yesNo(header.idsMatch));
+    writeField(out, "pipelineCacheUuidMatches", "Pipeline cache UUID matches pipelineCacheUUID: ", Cell::yesNo(header.uuidMatches));
+    endSection(out);
+
+    if (!scaling.empty()) {
+        renderTable(out, "pipelineBenchScaling", "Parallel pipeline creation:\n", scalingColumns, scaling);
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+namespace shw {
+    struct DeviceInfo;
+
+    // --device-pipeline-bench: creates a bundled set of compute pipelines
+    // cold, again without a VkPipelineCache, again from the now warm cache and
+    // once more from a cache rebuilt out of its serialized blob after a trip
+    // through a file. Reports each creation time, the blob size and whether
+    // the blob header matches the device's vendor, device and
+    // pipelineCacheUUID. With maxThreads above zero, fresh copies of the set
+    // are also created cold on 1, 2, 4 ... maxThreads threads.
+    void printDevicePipelineBench(const DeviceInfo& info, std::size_t maxThreads);
+}
@@ -0,0 +1,340 @@
+#include "probe-vk.h"
+#include "cache-vk.h"
+#include "device-vk.h"
+#include "dispatch-vk.h"
+#include "error-vk.h"
+#include "table-vk.h"
+#include "trace-vk.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <exception>
+
+namespace {
+    constexpr char probeMagic[8]{ 'S', 'H', 'W', 'V', 'K', 'P', 'R', 'B' };
+    constexpr std::uint32_t probeFormatVersion{ 1 };
+
+    // Layout: header, the two error texts, a serializeSnapshot() blob, then
+    // every device record followed by its extensions.
+    struct ProbeHeader {
+        char magic[8];
+        std::uint32_t formatVersion;
+        std::uint32_t deviceSize;
+        std::uint32_t extensionSize;
+        std::uint32_t instanceErrorSize;
+        std::uint32_t deviceErrorSize;
+        std::uint32_t snapshotSize;
+        std::uint32_t deviceCount;
+    };
+
+    struct DeviceRecord {
+        char name[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE];
+        std::uint32_t apiVersion;
+        std::uint32_t driverVersion;
+        std::uint32_t vendorID;
+        std::uint32_t deviceID;
+        std::int32_t type;
+        std::uint32_t extensionCount;
+    };
+
+    constexpr std::array<std::string_view, 6> probeSectionNames{
+        "instance", "instanceExtension", "layer", "layerExtension", "device", "deviceExtension"
+    };
+
+    constexpr std::array<std::string_view, 3> probeChangeNames{ "added", "removed", "changed" };
+
+    template<typename T>
+    void appendArray(std::string& out, const T* data, std::size_t count) {
+        out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+    }
+
+    // Bounds-checked cursor over a serialized probe, which may come from a
+    // pipe or a file and cannot be trusted.
+    class ProbeReader {
+    public:
+        ProbeReader(const void* data, std::size_t size)
+            : in_{ static_cast<const unsigned char*>(data) }, remaining_{ size } {}
+
+        const unsigned char* take(std::uint64_t size) {
+            if (in_ == nullptr || size > remaining_) {
+                return nullptr;
+            }
+            const unsigned char* data{ in_ };
+            in_ += size;
+            remaining_ -= static_cast<std::size_t>(size);
+            return data;
+        }
+
+        template<typename T>
+        bool read(T& value) {
+            const unsigned char* data{ take(sizeof(T)) };
+            if (data != nullptr) {
+                std::memcpy(&value, data, sizeof(T));
+            }
+            return data != nullptr;
+        }
+
+        template<typename T>
+        bool readArray(std::vector<T>& out, std::uint32_t count) {
+            const unsigned char* data{ take(std::uint64_t{ count } * sizeof(T)) };
+            if (data == nullptr) {
+                return false;
+            }
+            out.resize(count);
+            if (count > 0) {
+                std::memcpy(out.data(), data, count * sizeof(T));
+            }
+            return true;
+        }
+
+        bool readString(std::string& out, std::uint32_t size) {
+            const unsigned char* data{ take(size) };
+            if (data != nullptr) {
+                out.assign(reinterpret_cast<const char*>(data), size);
+            }
+            return data != nullptr;
+        }
+
+        bool atEnd() const { return remaining_ == 0; }
+
+    private:
+        const unsigned char* in_;
+        std::size_t remaining_;
+    };
+
+    std::string nameOf(const VkExtensionProperties& extension) {
+        return std::string{ shw::Cell::fixed(extension.extensionName).text };
+    }
+
+    bool isDeviceSection(shw::ProbeSection section) {
+        return section == shw::ProbeSection::Device || section == shw::ProbeSection::DeviceExtension;
+    }
+}
+
+shw::ProbeResult shw::probeCapabilities() {
+    const TraceScope scope{ "probeCapabilities" };
+    ProbeResult probe;
+    try {
+        takeInstanceSnapshot(probe.instance);
+    }
+    catch (const std::exception& error) {
+        probe.instanceError = error.what();
+        return probe;
+    }
+    try {
+        const ProbeInstance instance;
+        for (VkPhysicalDevice device : getPhysicalDevices(instance.get())) {
+            VkPhysicalDeviceProperties properties{};
+            SHW_VK_CALL(vkGetPhysicalDeviceProperties, device, &properties);
+            DeviceSummary& summary{ probe.devices.emplace_back() };
+            std::memcpy(summary.name, properties.deviceName, sizeof(summary.name));
+            summary.apiVersion = properties.apiVersion;
+            summary.driverVersion = properties.driverVersion;
+            summary.vendorID = properties.vendorID;
+            summary.deviceID = properties.deviceID;
+            summary.type = properties.deviceType;
+            summary.extensions = getDeviceExtensions(device);
+        }
+    }
+    catch (const std::exception& error) {
+        probe.devices.clear();
+        probe.deviceError = error.what();
+    }
+    return probe;
+}
+
+void shw::serializeProbe(const ProbeResult& probe, std::string& out) {
+    std::string snapshot;
+    if (probe.instanceError.empty()) {
+        // The fingerprint only means something to the cache file.
+        serializeSnapshot(probe.instance, 0, snapshot);
+    }
+    ProbeHeader header{};
+    std::memcpy(header.magic, probeMagic, sizeof(probeMagic));
+    header.formatVersion = probeFormatVersion;
+    header.deviceSize = sizeof(DeviceRecord);
+    header.extensionSize = sizeof(VkExtensionProperties);
+    header.instanceErrorSize = static_cast<std::uint32_t>(probe.instanceError.size());
+    header.deviceErrorSize = static_cast<std::uint32_t>(probe.deviceError.size());
+    header.snapshotSize = static_cast<std::uint32_t>(snapshot.size());
+    header.deviceCount = static_cast<std::uint32_t>(probe.devices.size());
+
+    std::size_t size{ sizeof(header) + probe.instanceError.size() + probe.deviceError.size() + snapshot.size() };
+    for (const auto& device : probe.devices) {
+        size += sizeof(DeviceRecord) + device.extensions.size() * sizeof(VkExtensionProperties);
+    }
+    out.clear();
+    out.reserve(size);
+    appendArray(out, &header, 1);
+    out += probe.instanceError;
+    out += probe.deviceError;
+    out += snapshot;
+    for (const auto& device : probe.devices) {
+        DeviceRecord record{};
+        std::memcpy(record.name, device.name, sizeof(record.name));
+        record.apiVersion = device.apiVersion;
+        record.driverVersion = device.driverVersion;
+        record.vendorID = device.vendorID;
+        record.deviceID = device.deviceID;
+        record.type = device.type;
+        record.extensionCount = static_cast<std::uint32_t>(device.extensions.size());
+        appendArray(out, &record, 1);
+        appendArray(out, device.extensions.data(), device.extensions.size());
+    }
+}
+
+bool shw::deserializeProbe(const void* data, std::size_t size, ProbeResult& probe) {
+    ProbeReader in{ data, size };
+    ProbeHeader header{};
+    if (!in.read(header)
+            || std::memcmp(header.magic, probeMagic, sizeof(probeMagic)) != 0
+            || header.formatVersion != probeFormatVersion
+            || header.deviceSize != sizeof(DeviceRecord)
+            || header.extensionSize != sizeof(VkExtensionProperties)) {
+        return false;
+    }
+    if (!in.readString(probe.instanceError, header.instanceErrorSize)
+            || !in.readString(probe.deviceError, header.deviceErrorSize)) {
+        return false;
+    }
+    const unsigned char* snapshot{ in.take(header.snapshotSize) };
+    if (snapshot == nullptr) {
+        return false;
+    }
+    probe.instance = {};
+    std::uint64_t fingerprint{};
+    if (header.snapshotSize > 0 && !deserializeSnapshot(snapshot, header.snapshotSize, fingerprint, probe.instance)) {
+        return false;
+    }
+    if (std::uint64_t{ header.deviceCount } * sizeof(DeviceRecord) > size) {
+        return false;
+    }
+    probe.devices.resize(header.deviceCount);
+    for (auto& device : probe.devices) {
+        DeviceRecord record{};
+        if (!in.read(record) || !in.readArray(device.extensions, record.extensionCount)) {
+            return false;
+        }
+        std::memcpy(device.name, record.name, sizeof(device.name));
+        device.name[sizeof(device.name) - 1] = '\0';
+        device.apiVersion = record.apiVersion;
+        device.driverVersion = record.driverVersion;
+        device.vendorID = record.vendorID;
+        device.deviceID = record.deviceID;
+        device.type = static_cast<VkPhysicalDeviceType>(record.type);
+    }
+    return in.atEnd();
+}
+
+std::string_view shw::probeSectionToStr(ProbeSection section) {
+    return probeSectionNames[static_cast<std::size_t>(section)];
+}
+
+std::string_view shw::probeChangeToStr(ProbeChange change) {
+    return probeChangeNames[static_cast<std::size_t>(change)];
+}
+
+std::vector<shw::ProbeEntry> shw::flattenProbe(const ProbeResult& probe) {
+    std::vector<ProbeEntry> entries;
+    if (!probe.instanceError.empty()) {
+        return entries;
+    }
+    const InstanceSnapshot& instance{ probe.instance };
+    entries.push_back({ ProbeSection::Instance, "version", instance.versionResult == VK_SUCCESS
+        ? versionToStr(instance.version) : std::string{ resultToStr(instance.versionResult) } });
+    for (const auto& extension : instance.extensions) {
+        entries.push_back({ ProbeSection::InstanceExtension, nameOf(extension), std::to_string(extension.specVersion) });
+    }
+    for (std::size_t i{}, length{ instance.layers.size() }; i < length; ++i) {
+        const auto& layer{ instance.layers[i] };
+        const std::string layerName{ Cell::fixed(layer.layerName).text };
+        entries.push_back({ ProbeSection::Layer, layerName,
+            versionToStr(layer.specVersion) + " (" + std::to_string(layer.implementationVersion) + ')' });
+        if (i < instance.layerExtensions.size()) {
+            for (const auto& extension : instance.layerExtensions[i]) {
+                entries.push_back({ ProbeSection::LayerExtension, layerName + ':' + nameOf(extension),
+                    std::to_string(extension.specVersion) });
+            }
+        }
+    }
+
+    // Devices are matched across probes by name; identical boards get #2, #3...
+    std::vector<std::string> deviceNames;
+    for (const auto& device : probe.devices) {
+        std::string name{ Cell::fixed(device.name).text };
+        const auto seen{ std::count(deviceNames.cbegin(), deviceNames.cend(), name) };
+        deviceNames.push_back(name);
+        if (seen > 0) {
+            name += " #" + std::to_string(seen + 1);
+        }
+        entries.push_back({ ProbeSection::Device, name + ":apiVersion", versionToStr(device.apiVersion) });
+        entries.push_back({ ProbeSection::Device, name + ":driverVersion", shw::hexToStr(device.driverVersion) });
+        entries.push_back({ ProbeSection::Device, name + ":type", std::string{ deviceTypeToStr(device.type) } });
+        entries.push_back({ ProbeSection::Device, name + ":id", shw::hexToStr(device.vendorID) + ':' + shw::hexToStr(device.deviceID) });
+        for (const auto& extension : device.extensions) {
+            entries.push_back({ ProbeSection::DeviceExtension, name + ':' + nameOf(extension),
+                std::to_string(extension.specVersion) });
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), probeEntryLess);
+    // A name reported twice would throw the merge out of step.
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const ProbeEntry& a, const ProbeEntry& b) {
+        return a.section == b.section && a.name == b.name; }), entries.end());
+    return entries;
+}
+
+std::vector<shw::ProbeDiffRow> shw::diffProbes(const std::vector<const ProbeResult*>& probes) {
+    const TraceScope scope{ "diffProbes" };
+    const std::size_t count{ probes.size() };
+    std::vector<std::vector<ProbeEntry>> entries(count);
+    for (std::size_t i{}; i < count; ++i) {
+        entries[i] = flattenProbe(*probes[i]);
+    }
+    auto known{ [&](std::size_t i, ProbeSection section) {
+        return probes[i]->instanceError.empty() && (probes[i]->deviceError.empty() || !isDeviceSection(section));
+    } };
+
+    std::vector<ProbeDiffRow> rows;
+    std::vector<std::size_t> next(count);
+    for (;;) {
+        const ProbeEntry* lowest{};
+        for (std::size_t i{}; i < count; ++i) {
+            if (next[i] < entries[i].size() && (lowest == nullptr || probeEntryLess(entries[i][next[i]], *lowest))) {
+                lowest = &entries[i][next[i]];
+            }
+        }
+        if (lowest == nullptr) {
+            break;
+        }
+        ProbeDiffRow& row{ rows.emplace_back() };
+        row.section = lowest->section;
+        row.name = lowest->name;
+        row.values.reserve(count);
+        row.differs = false;
+        std::size_t reference{ count };
+        for (std::size_t i{}; i < count; ++i) {
+            if (!known(i, row.section)) {
+                // A configuration that could not be read cannot vouch for
+                // the entry being the same.
+                row.values.emplace_back(unknownValue);
+                row.differs = true;
+                continue;
+            }
+            const bool present{ next[i] < entries[i].size()
+                && entries[i][next[i]].section == row.section && entries[i][next[i]].name == row.name };
+            row.values.emplace_back(present ? std::string_view{ entries[i][next[i]].value } : absentValue);
+            if (present) {
+                ++next[i];
+            }
+            if (reference == count) {
+                reference = i;
+            }
+            else if (row.values.back() != row.values[reference]) {
+                row.differs = true;
+            }
+        }
+    }
+    return rows;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "snapshot-vk.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace shw {
+    // The part of a physical device that changes with driver and loader setups.
+    struct DeviceSummary {
+        char name[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE]{};
+        std::uint32_t apiVersion{};
+        std::uint32_t driverVersion{};
+        std::uint32_t vendorID{};
+        std::uint32_t deviceID{};
+        VkPhysicalDeviceType type{};
+        std::vector<VkExtensionProperties> extensions;
+    };
+
+    // Instance and device capabilities as seen by one loader configuration.
+    // A failure is recorded instead of thrown so that a broken setup still
+    // shows up next to the working ones.
+    struct ProbeResult {
+        InstanceSnapshot instance;
+        std::vector<DeviceSummary> devices;
+        // Empty when the instance level (and the devices) could be read.
+        std::string instanceError;
+        // Empty when the devices could be enumerated.
+        std::string deviceError;
+
+        bool failed() const { return !instanceError.empty() || !deviceError.empty(); }
+    };
+
+    // Probes the loader of this process; never throws for Vulkan errors.
+    ProbeResult probeCapabilities();
+
+    void serializeProbe(const ProbeResult& probe, std::string& out);
+    bool deserializeProbe(const void* data, std::size_t size, ProbeResult& probe);
+
+    enum class ProbeSection : std::uint8_t {
+        Instance,
+        InstanceExtension,
+        Layer,
+        LayerExtension,
+        Device,
+        DeviceExtension,
+    };
+
+    std::string_view probeSectionToStr(ProbeSection section);
+
+    // One comparable fact of a probe. Layer and device entries are named
+    // OWNER:NAME, as in the support queries.
+    struct ProbeEntry {
+        ProbeSection section;
+        std::string name;
+        std::string value;
+    };
+
+    inline bool probeEntryLess(const ProbeEntry& a, const ProbeEntry& b) {
+        return a.section != b.section ? a.section < b.section : a.name < b.name;
+    }
+
+    // Sorted by section, then name.
+    std::vector<ProbeEntry> flattenProbe(const ProbeResult& probe);
+
+    enum class ProbeChange : std::uint8_t { Added, Removed, Changed };
+
+    std::string_view probeChangeToStr(ProbeChange change);
+
+    // Walks two flattenProbe() lists once and calls
+    // visit(change, beforeEntry, afterEntry) for every entry that was added,
+    // removed or changed; the missing side is null. Stops as soon as visit
+    // returns false. Returns the number of changes visited.
+    template<typename Visit>
+    std::size_t compareProbeEntries(const std::vector<ProbeEntry>& before, const std::vector<ProbeEntry>& after, Visit&& visit) {
+        std::size_t changes{};
+        auto report{ [&](ProbeChange change, const ProbeEntry* from, const ProbeEntry* to) {
+            ++changes;
+            return visit(change, from, to);
+        } };
+        auto b{ before.cbegin() };
+        auto a{ after.cbegin() };
+        while (b != before.cend() || a != after.cend()) {
+            bool more{ true };
+            if (a == after.cend() || (b != before.cend() && probeEntryLess(*b, *a))) {
+                more = report(ProbeChange::Removed, &*b++, nullptr);
+            }
+            else if (b == before.cend() || probeEntryLess(*a, *b)) {
+                more = report(ProbeChange::Added, nullptr, &*a++);
+            }
+            else {
+                if (b->value != a->value) {
+                    more = report(ProbeChange::Changed, &*b, &*a);
+                }
+                ++b;
+                ++a;
+            }
+            if (!more) {
+                break;
+            }
+        }
+        return changes;
+    }
+
+    // Cell values for probes that lack an entry or failed to read its section.
+    inline constexpr std::string_view absentValue{ "-" };
+    inline constexpr std::string_view unknownValue{ "?" };
+
+    // One row of a side-by-side comparison with a value per probe.
+    struct ProbeDiffRow {
+        ProbeSection section;
+        std::string name;
+        std::vector<std::string> values;
+        // Whether the probes disagree or any of them could not read this section.
+        bool differs;
+    };
+
+    // Merges the sorted entries of every probe into one row per distinct entry.
+    std::vector<ProbeDiffRow> diffProbes(const std::vector<const ProbeResult*>& probes);
+}
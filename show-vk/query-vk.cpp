@@ -0,0 +1,87 @@
+#include "query-vk.h"
+#include "snapshot-vk.h"
+#include "cache-vk.h"
+#include "index-vk.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+    template<typename T>
+    VkResult copyOut(const std::vector<T>& source, std::uint32_t& count, T* destination) {
+        if (destination == nullptr) {
+            count = static_cast<std::uint32_t>(source.size());
+            return VK_SUCCESS;
+        }
+        const std::uint32_t written{ std::min(count, static_cast<std::uint32_t>(source.size())) };
+        std::copy_n(source.cbegin(), written, destination);
+        count = written;
+        return written < source.size() ? VK_INCOMPLETE : VK_SUCCESS;
+    }
+
+    template<typename Find>
+    void markSupported(Find find, const char* const* names, std::uint32_t count, VkBool32* supported) {
+        for (std::uint32_t i{}; i < count; ++i) {
+            supported[i] = names[i] != nullptr && !find(shw::parseNameQuery(names[i])).empty() ? VK_TRUE : VK_FALSE;
+        }
+    }
+}
+
+void shw::refreshInstanceSnapshot(InstanceSnapshot& snapshot, bool useCache) {
+    if (useCache) {
+        takeCachedInstanceSnapshot(snapshot);
+    }
+    else {
+        takeInstanceSnapshot(snapshot);
+    }
+}
+
+VkResult shw::queryInstanceVersion(const InstanceSnapshot& snapshot, std::uint32_t& version) {
+    version = snapshot.version;
+    return snapshot.versionResult;
+}
+
+VkResult shw::queryInstanceExtensions(const InstanceSnapshot& snapshot,
+        std::uint32_t& count, VkExtensionProperties* extensions) {
+    return copyOut(snapshot.extensions, count, extensions);
+}
+
+VkResult shw::queryInstanceLayers(const InstanceSnapshot& snapshot,
+        std::uint32_t& count, VkLayerProperties* layers) {
+    return copyOut(snapshot.layers, count, layers);
+}
+
+VkResult shw::queryLayerExtensions(const InstanceSnapshot& snapshot, const char* layerName,
+        std::uint32_t& count, VkExtensionProperties* extensions) {
+    if (layerName == nullptr) {
+        return queryInstanceExtensions(snapshot, count, extensions);
+    }
+    for (std::size_t i{}, length{ snapshot.layers.size() }; i < length; ++i) {
+        if (std::strcmp(snapshot.layers[i].layerName, layerName) == 0) {
+            return copyOut(snapshot.layerExtensions[i], count, extensions);
+        }
+    }
+    count = 0;
+    return VK_ERROR_LAYER_NOT_PRESENT;
+}
+
+void shw::queryInstanceExtensionsSupport(const NameIndex& index,
+        const char* const* names, std::uint32_t count, VkBool32* supported) {
+    markSupported([&](const NameQuery& query) { return index.findExtensions(query); }, names, count, supported);
+}
+
+void shw::queryInstanceLayersSupport(const NameIndex& index,
+        const char* const* names, std::uint32_t count, VkBool32* supported) {
+    markSupported([&](const NameQuery& query) { return index.findLayers(query); }, names, count, supported);
+}
+
+void shw::queryInstanceExtensionsSupport(const InstanceSnapshot& snapshot,
+        const char* const* names, std::uint32_t count, VkBool32* supported) {
+    queryInstanceExtensionsSupport(NameIndex{ snapshot }, names, count, supported);
+}
+
+void shw::queryInstanceLayersSupport(const InstanceSnapshot& snapshot,
+        const char* const* names, std::uint32_t count, VkBool32* supported) {
+    queryInstanceLayersSupport(NameIndex{ snapshot }, names, count, supported);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+namespace shw {
+    struct InstanceSnapshot;
+    class NameIndex;
+
+    // Query interface for processes that embed show-vk instead of running it.
+    // Nothing here touches iostreams or builds strings. The array queries follow
+    // the Vulkan two-call idiom: with a null buffer count receives the number of
+    // entries, otherwise at most count entries are copied, count is set to the
+    // number written and VK_INCOMPLETE signals a short buffer.
+
+    // Re-reads instance data into an existing snapshot. The snapshot keeps its
+    // allocations between calls, so polling settles into copying only.
+    void refreshInstanceSnapshot(InstanceSnapshot& snapshot, bool useCache = true);
+
+    VkResult queryInstanceVersion(const InstanceSnapshot& snapshot, std::uint32_t& version);
+    VkResult queryInstanceExtensions(const InstanceSnapshot& snapshot,
+        std::uint32_t& count, VkExtensionProperties* extensions);
+    VkResult queryInstanceLayers(const InstanceSnapshot& snapshot,
+        std::uint32_t& count, VkLayerProperties* layers);
+    // VK_ERROR_LAYER_NOT_PRESENT if no layer called layerName was enumerated.
+    VkResult queryLayerExtensions(const InstanceSnapshot& snapshot, const char* layerName,
+        std::uint32_t& count, VkExtensionProperties* extensions);
+
+    // supported[i] is set to VK_TRUE when names[i] is available. Names take the
+    // NAME, NAME* and LAYER:NAME[*] forms of parseNameQuery(); extensions count
+    // as available when the loader or any layer provides them. The snapshot
+    // overloads index the snapshot for the one call; callers that check
+    // repeatedly should build a NameIndex once and pass that instead.
+    void queryInstanceExtensionsSupport(const NameIndex& index,
+        const char* const* names, std::uint32_t count, VkBool32* supported);
+    void queryInstanceLayersSupport(const NameIndex& index,
+        const char* const* names, std::uint32_t count, VkBool32* supported);
+    void queryInstanceExtensionsSupport(const InstanceSnapshot& snapshot,
+        const char* const* names, std::uint32_t count, VkBool32* supported);
+    void queryInstanceLayersSupport(const InstanceSnapshot& snapshot,
+        const char* const* names, std::uint32_t count, VkBool32* supported);
+}
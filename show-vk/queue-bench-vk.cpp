@@ -0,0 +1,301 @@
+#include "queue-bench-vk.h"
+#include "bench-vk.h"
+#include "device-vk.h"
+#include "error-vk.h"
+#include "spirv-vk.h"
+#include "table-vk.h"
+#include "trace-vk.h"
+
+#include <array>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+    constexpr std::array<std::uint32_t, 7> batchSizes{ 1, 2, 4, 8, 16, 32, 64 };
+    constexpr std::size_t submitIterations{ 256 };
+    constexpr std::size_t dispatchIterations{ 64 };
+    // A hung queue should fail the run rather than stall it.
+    constexpr std::uint64_t fenceTimeoutNs{ 5'000'000'000 };
+    // Queries 0 and 1 bracket the batch.
+    constexpr std::uint32_t timestampCount{ 2 };
+
+    struct QueueBenchRow {
+        std::uint32_t family;
+        std::string_view test;
+        std::uint32_t batch;
+        std::string_view clock;
+        shw::BenchStats stats;
+        // Dispatches per second at the median; zero for the submit tests.
+        double rate;
+    };
+
+    constexpr shw::Column<QueueBenchRow> queueBenchColumns[]{
+        { "family", "Family", shw::Align::Right, [](const QueueBenchRow& row) { return shw::Cell::number(row.family); } },
+        { "test", "Test", shw::Align::Left, [](const QueueBenchRow& row) { return shw::Cell::str(row.test); } },
+        { "batch", "Batch", shw::Align::Right, [](const QueueBenchRow& row) { return shw::Cell::number(row.batch); } },
+        { "clock", "Clock", shw::Align::Left, [](const QueueBenchRow& row) { return shw::Cell::str(row.clock); } },
+        { "samples", "Samples", shw::Align::Right, [](const QueueBenchRow& row) { return shw::Cell::number(row.stats.samples); } },
+        { "p50Ns", "p50 ns", shw::Align::Right, [](const QueueBenchRow& row) { return shw::Cell::number(row.stats.p50); } },
+        { "p90Ns", "p90 ns", shw::Align::Right, [](const QueueBenchRow& row) { return shw::Cell::number(row.stats.p90); } },
+        { "p99Ns", "p99 ns", shw::Align::Right, [](const QueueBenchRow& row) { return shw::Cell::number(row.stats.p99); } },
+        { "maxNs", "max ns", shw::Align::Right, [](const QueueBenchRow& row) { return shw::Cell::number(row.stats.max); } },
+        { "dispatchesPerSecond", "Dispatches/s", shw::Align::Right, [](const QueueBenchRow& row) { return shw::Cell::real(row.rate); } },
+    };
+
+    std::vector<std::uint32_t> usableFamilies(const shw::DeviceInfo& info) {
+        std::vector<std::uint32_t> families;
+        for (std::uint32_t i{}, length{ static_cast<std::uint32_t>(info.queueFamilies.size()) }; i < length; ++i) {
+            if (info.queueFamilies[i].queueCount > 0) {
+                families.push_back(i);
+            }
+        }
+        return families;
+    }
+
+    // Objects that belong to one queue family, released in reverse order once
+    // the device is idle, even when a measurement throws.
+    struct FamilyObjects {
+        FamilyObjects(VkDevice device, const shw::DeviceFunctions& functions) : device{ device }, functions{ functions } {}
+        ~FamilyObjects() {
+            // A measurement that threw may have left a submit pending on these.
+            SHW_VK_DEVICE_CALL(functions, vkDeviceWaitIdle, device);
+            SHW_VK_DEVICE_CALL(functions, vkDestroyQueryPool, device, queryPool, nullptr);
+            SHW_VK_DEVICE_CALL(functions, vkDestroyFence, device, fence, nullptr);
+            SHW_VK_DEVICE_CALL(functions, vkDestroyCommandPool, device, commandPool, nullptr);
+        }
+
+        FamilyObjects(const FamilyObjects&) = delete;
+        FamilyObjects& operator=(const FamilyObjects&) = delete;
+
+        VkDevice device;
+        const shw::DeviceFunctions& functions;
+        VkCommandPool commandPool{};
+        VkFence fence{};
+        VkQueryPool queryPool{};
+        // The timestamp reset and begin, one dispatch per batch slot, then the end.
+        VkCommandBuffer begin{};
+        std::vector<VkCommandBuffer> dispatches;
+        VkCommandBuffer end{};
+    };
+
+    class QueueBench {
+    public:
+        QueueBench(const shw::DeviceInfo& info, std::vector<QueueBenchRow>& rows)
+            : info_{ info }, device_{ info.device, usableFamilies(info) }, functions_{ device_.functions() }, rows_{ rows } {
+        }
+
+        ~QueueBench() {
+            VkDevice device{ device_.get() };
+            SHW_VK_DEVICE_CALL(functions_, vkDestroyPipeline, device, pipeline_, nullptr);
+            SHW_VK_DEVICE_CALL(functions_, vkDestroyPipelineLayout, device, layout_, nullptr);
+            SHW_VK_DEVICE_CALL(functions_, vkDestroyShaderModule, device, shader_, nullptr);
+        }
+
+        QueueBench(const QueueBench&) = delete;
+        QueueBench& operator=(const QueueBench&) = delete;
+
+        void createPipeline() {
+            VkDevice device{ device_.get() };
+            VkShaderModuleCreateInfo shaderInfo{};
+            shaderInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+            shaderInfo.codeSize = sizeof(shw::emptyComputeShader);
+            shaderInfo.pCode = shw::emptyComputeShader;
+            check(SHW_VK_DEVICE_CALL(functions_, vkCreateShaderModule, device, &shaderInfo, nullptr, &shader_), "vkCreateShaderModule() failed");
+
+            VkPipelineLayoutCreateInfo layoutInfo{};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            check(SHW_VK_DEVICE_CALL(functions_, vkCreatePipelineLayout, device, &layoutInfo, nullptr, &layout_), "vkCreatePipelineLayout() failed");
+
+            VkComputePipelineCreateInfo pipelineInfo{};
+            pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            pipelineInfo.stage.module = shader_;
+            pipelineInfo.stage.pName = "main";
+            pipelineInfo.layout = layout_;
+            check(SHW_VK_DEVICE_CALL(functions_, vkCreateComputePipelines, device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline_),
+                "vkCreateComputePipelines() failed");
+        }
+
+        void run(std::uint32_t family) {
+            const shw::TraceScope scope{ "queueBenchFamily" };
+            const VkQueueFamilyProperties& properties{ info_.queueFamilies[family] };
+            const bool compute{ (properties.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 };
+            const bool timestamps{ compute && properties.timestampValidBits > 0 };
+
+            FamilyObjects objects{ device_.get(), functions_ };
+            createObjects(family, compute, timestamps, objects);
+            benchSubmit(family, objects);
+            if (compute) {
+                benchDispatch(family, properties.timestampValidBits, timestamps, objects);
+            }
+        }
+
+    private:
+        static void check(VkResult result, const char* message) {
+            if (result != VK_SUCCESS) {
+                throw std::runtime_error{ shw::getError(message, result) };
+            }
+        }
+
+        void createObjects(std::uint32_t family, bool compute, bool timestamps, FamilyObjects& objects) {
+            VkDevice device{ device_.get() };
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            check(SHW_VK_DEVICE_CALL(functions_, vkCreateFence, device, &fenceInfo, nullptr, &objects.fence), "vkCreateFence() failed");
+            if (!compute) {
+                return;
+            }
+
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.queueFamilyIndex = family;
+            check(SHW_VK_DEVICE_CALL(functions_, vkCreateCommandPool, device, &poolInfo, nullptr, &objects.commandPool), "vkCreateCommandPool() failed");
+
+            std::vector<VkCommandBuffer> buffers(batchSizes.back() + 2);
+            VkCommandBufferAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocateInfo.commandPool = objects.commandPool;
+            allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocateInfo.commandBufferCount = static_cast<std::uint32_t>(buffers.size());
+            check(SHW_VK_DEVICE_CALL(functions_, vkAllocateCommandBuffers, device, &allocateInfo, buffers.data()), "vkAllocateCommandBuffers() failed");
+            objects.begin = buffers.front();
+            objects.end = buffers.back();
+            objects.dispatches.assign(buffers.begin() + 1, buffers.end() - 1);
+
+            if (timestamps) {
+                VkQueryPoolCreateInfo queryInfo{};
+                queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                queryInfo.queryCount = timestampCount;
+                check(SHW_VK_DEVICE_CALL(functions_, vkCreateQueryPool, device, &queryInfo, nullptr, &objects.queryPool), "vkCreateQueryPool() failed");
+            }
+
+            // Recorded once and resubmitted; every submit waits for its fence
+            // before the next one, so no buffer is ever pending twice.
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            check(SHW_VK_DEVICE_CALL(functions_, vkBeginCommandBuffer, objects.begin, &beginInfo), "vkBeginCommandBuffer() failed");
+            if (timestamps) {
+                SHW_VK_DEVICE_CALL(functions_, vkCmdResetQueryPool, objects.begin, objects.queryPool, 0, timestampCount);
+                SHW_VK_DEVICE_CALL(functions_, vkCmdWriteTimestamp, objects.begin, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, objects.queryPool, 0);
+            }
+            check(SHW_VK_DEVICE_CALL(functions_, vkEndCommandBuffer, objects.begin), "vkEndCommandBuffer() failed");
+
+            for (VkCommandBuffer buffer : objects.dispatches) {
+                check(SHW_VK_DEVICE_CALL(functions_, vkBeginCommandBuffer, buffer, &beginInfo), "vkBeginCommandBuffer() failed");
+                SHW_VK_DEVICE_CALL(functions_, vkCmdBindPipeline, buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_);
+                SHW_VK_DEVICE_CALL(functions_, vkCmdDispatch, buffer, 1, 1, 1);
+                check(SHW_VK_DEVICE_CALL(functions_, vkEndCommandBuffer, buffer), "vkEndCommandBuffer() failed");
+            }
+
+            check(SHW_VK_DEVICE_CALL(functions_, vkBeginCommandBuffer, objects.end, &beginInfo), "vkBeginCommandBuffer() failed");
+            if (timestamps) {
+                SHW_VK_DEVICE_CALL(functions_, vkCmdWriteTimestamp, objects.end, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, objects.queryPool, 1);
+            }
+            check(SHW_VK_DEVICE_CALL(functions_, vkEndCommandBuffer, objects.end), "vkEndCommandBuffer() failed");
+        }
+
+        // Submits and waits for the fence; returns the host time at which the
+        // submit call returned.
+        std::uint64_t submitAndWait(VkQueue queue, const VkSubmitInfo& submitInfo, VkFence fence) {
+            VkDevice device{ device_.get() };
+            check(SHW_VK_DEVICE_CALL(functions_, vkQueueSubmit, queue, 1, &submitInfo, fence), "vkQueueSubmit() failed");
+            const std::uint64_t submitted{ shw::benchClock() };
+            check(SHW_VK_DEVICE_CALL(functions_, vkWaitForFences, device, 1, &fence, VK_TRUE, fenceTimeoutNs), "vkWaitForFences() failed");
+            check(SHW_VK_DEVICE_CALL(functions_, vkResetFences, device, 1, &fence), "vkResetFences() failed");
+            return submitted;
+        }
+
+        // Consumes samples, leaving the vector empty for the next test.
+        void addRow(std::uint32_t family, std::string_view test, std::uint32_t batch, std::string_view clock,
+                std::vector<std::uint64_t>& samples, bool rate) {
+            const shw::BenchStats stats{ shw::summarize(samples) };
+            samples.clear();
+            const double perSecond{ rate && stats.p50 > 0 ? batch * 1e9 / static_cast<double>(stats.p50) : 0.0 };
+            rows_.push_back({ family, test, batch, clock, stats, perSecond });
+        }
+
+        void benchSubmit(std::uint32_t family, const FamilyObjects& objects) {
+            const VkQueue queue{ device_.queue(family) };
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            std::vector<std::uint64_t> submitSamples;
+            std::vector<std::uint64_t> roundTripSamples;
+            submitSamples.reserve(submitIterations);
+            roundTripSamples.reserve(submitIterations);
+            for (std::size_t i{}; i < submitIterations; ++i) {
+                const std::uint64_t start{ shw::benchClock() };
+                const std::uint64_t submitted{ submitAndWait(queue, submitInfo, objects.fence) };
+                const std::uint64_t signaled{ shw::benchClock() };
+                submitSamples.push_back(submitted - start);
+                roundTripSamples.push_back(signaled - start);
+            }
+            addRow(family, "emptySubmit", 0, "host", submitSamples, false);
+            addRow(family, "fenceRoundTrip", 0, "host", roundTripSamples, false);
+        }
+
+        void benchDispatch(std::uint32_t family, std::uint32_t timestampBits, bool timestamps, const FamilyObjects& objects) {
+            VkDevice device{ device_.get() };
+            const VkQueue queue{ device_.queue(family) };
+            const std::uint64_t timestampMask{ timestampBits >= 64 ? ~std::uint64_t{} : (std::uint64_t{ 1 } << timestampBits) - 1 };
+            const double timestampPeriod{ info_.properties.limits.timestampPeriod };
+
+            std::vector<VkCommandBuffer> buffers;
+            std::vector<std::uint64_t> hostSamples;
+            std::vector<std::uint64_t> deviceSamples;
+            hostSamples.reserve(dispatchIterations);
+            deviceSamples.reserve(dispatchIterations);
+            for (std::uint32_t batch : batchSizes) {
+                buffers.clear();
+                buffers.push_back(objects.begin);
+                buffers.insert(buffers.end(), objects.dispatches.begin(), objects.dispatches.begin() + batch);
+                buffers.push_back(objects.end);
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfo.commandBufferCount = static_cast<std::uint32_t>(buffers.size());
+                submitInfo.pCommandBuffers = buffers.data();
+
+                for (std::size_t i{}; i < dispatchIterations; ++i) {
+                    const std::uint64_t start{ shw::benchClock() };
+                    submitAndWait(queue, submitInfo, objects.fence);
+                    hostSamples.push_back(shw::benchClock() - start);
+                    if (timestamps) {
+                        std::uint64_t ticks[timestampCount]{};
+                        check(SHW_VK_DEVICE_CALL(functions_, vkGetQueryPoolResults, device, objects.queryPool, 0, timestampCount,
+                            sizeof(ticks), ticks, sizeof(ticks[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT),
+                            "vkGetQueryPoolResults() failed");
+                        const std::uint64_t elapsed{ (ticks[1] - ticks[0]) & timestampMask };
+                        deviceSamples.push_back(static_cast<std::uint64_t>(static_cast<double>(elapsed) * timestampPeriod));
+                    }
+                }
+                addRow(family, "dispatch", batch, "host", hostSamples, true);
+                if (timestamps) {
+                    addRow(family, "dispatch", batch, "device", deviceSamples, true);
+                }
+            }
+        }
+
+        const shw::DeviceInfo& info_;
+        shw::BenchDevice device_;
+        const shw::DeviceFunctions& functions_;
+        std::vector<QueueBenchRow>& rows_;
+        VkShaderModule shader_{};
+        VkPipelineLayout layout_{};
+        VkPipeline pipeline_{};
+    };
+}
+
+void shw::printDeviceQueueBench(const DeviceInfo& info) {
+    const TraceScope scope{ "printDeviceQueueBench" };
+    std::vector<QueueBenchRow> rows;
+    {
+        QueueBench bench{ info, rows };
+        bench.createPipeline();
+        for (std::uint32_t family : usableFamilies(info)) {
+            bench.run(family);
+        }
+    }
+    renderTable(output(), "queueBench", "Device queue benchmark:\n", queueBenchColumns, rows);
+}
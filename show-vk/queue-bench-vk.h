@@ -0,0 +1,12 @@
+#pragma once
+
+namespace shw {
+    struct DeviceInfo;
+
+    // --device-queue-bench: per queue family, the host cost of an empty
+    // vkQueueSubmit, the round trip until its fence signals, and for compute
+    // families the time to run batches of 1 to 64 command buffers holding one
+    // empty dispatch each. Batches are timed on the host and, where the family
+    // has timestamps, on the device as well.
+    void printDeviceQueueBench(const DeviceInfo& info);
+}
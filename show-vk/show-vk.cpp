@@ -1,38 +1,68 @@
 ﻿#include "show-vk.h"
 
-#include <iostream>
-#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
 #include <string>
-#include <iterator>
-#include <unordered_map>
-#include <unordered_set>
-#include <regex>
-#include <string>
-#include <vector>
-
-#include "show-vk.h"
 
-void shw::parseArgs(const std::vector<std::string>& args) {
-    std::unordered_map<std::string, bool> instanceInfoOptions{
-        {instanceAllOption, false},
-        {instanceVersionOption, false},
-        {instanceShowExtensionsOption, false},
-        {instanceShowLayersOption, false}
-    };
-    std::unordered_map<std::string, std::vector<std::string>> instanceSupportOptions{};
+int shw::parseArgs(int argc, const char* const* argv) {
+    // Declared first so the trace also covers the final flush.
+    TraceWriteGuard traceGuard;
+    // Everything printed below lands in one buffer and is written out in one go.
+    OutputFlushGuard flushGuard;
+    Options options;
+    parseOptions(argc, argv, options);
+    if (options.isSet(Option::Trace)) {
+        enableTrace(options.value(Option::Trace));
+    }
+    if (options.isSet(Option::VulkanLibrary)) {
+        setVulkanLibrary(options.value(Option::VulkanLibrary));
+    }
+    if (options.isSet(Option::ProbeWorker)) {
+        runProbeWorker();
+        return 0;
+    }
 
-    for (const auto& arg : args) {
-        parseInstanceOption(arg, instanceInfoOptions, instanceSupportOptions);
+    OutputBuffer& out{ output() };
+    if (options.isSet(Option::Format)) {
+        OutputFormat format{};
+        if (!parseOutputFormat(options.value(Option::Format), format)) {
+            throw std::runtime_error{ "Unknown output format: " + std::string{ options.value(Option::Format) } };
+        }
+        out.setFormat(format);
+    }
+    beginDocument(out);
+    {
+        const TraceScope scope{ "executeInstanceOptions" };
+        executeInstanceOptions(options);
     }
-    executeInstanceOptions(instanceInfoOptions, instanceSupportOptions);
+    {
+        const TraceScope scope{ "executeDeviceOptions" };
+        executeDeviceOptions(options);
+    }
+    int exitCode{};
+    {
+        const TraceScope scope{ "executeConfigOptions" };
+        exitCode = executeConfigOptions(options, argc > 0 ? argv[0] : nullptr);
+    }
+    {
+        const TraceScope scope{ "executeBaselineOptions" };
+        exitCode = std::max(exitCode, executeBaselineOptions(options));
+    }
+    endDocument(out);
+    out.flush();
+    return exitCode;
 }
 
 int main(int argc, char* argv[]) {
-	std::cout << "Hello CMake!\n";
-    std::vector<std::string> args;
-    args.reserve(argc);
-    std::copy(argv, argv + argc, std::back_inserter(args));
-    shw::parseArgs(args);
-
-    // .\show-vk.exe --instance-support-extensions=VK_KHR_surface,VK_KHR_external_fence_capabilities,VK_dummy  --instance-support-layers=VK_LAYER_NV_optimus,VK_LAYER_LUNARG_api_dump,VK_dummy 
+    // Caught here rather than left to std::terminate so the stack unwinds and
+    // the trace and output guards in parseArgs() still run.
+    try {
+        return shw::parseArgs(argc, argv);
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return shw::errorExitCode;
+    }
 }
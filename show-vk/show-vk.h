@@ -1,8 +1,17 @@
 ﻿#pragma once
 
+#include "baseline-vk.h"
+#include "configs-vk.h"
+#include "dispatch-vk.h"
 #include "error-vk.h"
 #include "instance-vk.h"
+#include "device-vk.h"
+#include "format-vk.h"
+#include "options-vk.h"
+#include "table-vk.h"
+#include "trace-vk.h"
 
 namespace shw {
-	void parseArgs(const std::vector<std::string>& args);
+	// Returns the process exit code.
+	int parseArgs(int argc, const char* const* argv);
 }
@@ -0,0 +1,21 @@
+#include "snapshot-vk.h"
+#include "dispatch-vk.h"
+#include "instance-vk.h"
+#include "trace-vk.h"
+
+void shw::takeInstanceSnapshot(InstanceSnapshot& snapshot) {
+    const TraceScope scope{ "takeInstanceSnapshot" };
+    snapshot.versionResult = SHW_VK_CALL(vkEnumerateInstanceVersion, &snapshot.version);
+    getInstanceExtensions(nullptr, snapshot.extensions);
+    getInstanceLayers(snapshot.layers);
+    snapshot.layerExtensions.resize(snapshot.layers.size());
+    for (std::size_t i{}, length{ snapshot.layers.size() }; i < length; ++i) {
+        getInstanceExtensions(snapshot.layers[i].layerName, snapshot.layerExtensions[i]);
+    }
+}
+
+shw::InstanceSnapshot shw::takeInstanceSnapshot() {
+    InstanceSnapshot snapshot;
+    takeInstanceSnapshot(snapshot);
+    return snapshot;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace shw {
+    // Instance level data gathered from the loader in a single pass, so every
+    // printer and support check reads the same enumeration instead of
+    // rescanning the ICD and layer manifests.
+    struct InstanceSnapshot {
+        VkResult versionResult{ VK_SUCCESS };
+        std::uint32_t version{};
+        std::vector<VkExtensionProperties> extensions;
+        std::vector<VkLayerProperties> layers;
+        // layerExtensions[i] holds the instance extensions provided by layers[i]
+        std::vector<std::vector<VkExtensionProperties>> layerExtensions;
+    };
+
+    InstanceSnapshot takeInstanceSnapshot();
+    // Refills an existing snapshot, reusing the capacity of its vectors.
+    void takeInstanceSnapshot(InstanceSnapshot& snapshot);
+}
@@ -0,0 +1,146 @@
+#include "spirv-vk.h"
+
+#include <initializer_list>
+#include <utility>
+
+namespace {
+    // The handful of opcodes and enumerants buildXorshiftShader() needs.
+    namespace op {
+        constexpr std::uint32_t Capability{ 17 };
+        constexpr std::uint32_t MemoryModel{ 14 };
+        constexpr std::uint32_t EntryPoint{ 15 };
+        constexpr std::uint32_t ExecutionMode{ 16 };
+        constexpr std::uint32_t Decorate{ 71 };
+        constexpr std::uint32_t MemberDecorate{ 72 };
+        constexpr std::uint32_t TypeVoid{ 19 };
+        constexpr std::uint32_t TypeInt{ 21 };
+        constexpr std::uint32_t TypeVector{ 23 };
+        constexpr std::uint32_t TypeRuntimeArray{ 29 };
+        constexpr std::uint32_t TypeStruct{ 30 };
+        constexpr std::uint32_t TypePointer{ 32 };
+        constexpr std::uint32_t TypeFunction{ 33 };
+        constexpr std::uint32_t Constant{ 43 };
+        constexpr std::uint32_t Function{ 54 };
+        constexpr std::uint32_t FunctionEnd{ 56 };
+        constexpr std::uint32_t Variable{ 59 };
+        constexpr std::uint32_t Load{ 61 };
+        constexpr std::uint32_t Store{ 62 };
+        constexpr std::uint32_t AccessChain{ 65 };
+        constexpr std::uint32_t CompositeExtract{ 81 };
+        constexpr std::uint32_t ShiftRightLogical{ 194 };
+        constexpr std::uint32_t ShiftLeftLogical{ 196 };
+        constexpr std::uint32_t BitwiseXor{ 198 };
+        constexpr std::uint32_t Label{ 248 };
+        constexpr std::uint32_t Return{ 253 };
+    }
+
+    constexpr std::uint32_t capabilityShader{ 1 };
+    constexpr std::uint32_t addressingLogical{ 0 };
+    constexpr std::uint32_t memoryModelGlsl450{ 1 };
+    constexpr std::uint32_t executionModelGlCompute{ 5 };
+    constexpr std::uint32_t executionModeLocalSize{ 17 };
+    constexpr std::uint32_t decorationBufferBlock{ 3 };
+    constexpr std::uint32_t decorationArrayStride{ 6 };
+    constexpr std::uint32_t decorationBuiltIn{ 11 };
+    constexpr std::uint32_t decorationBinding{ 33 };
+    constexpr std::uint32_t decorationDescriptorSet{ 34 };
+    constexpr std::uint32_t decorationOffset{ 35 };
+    constexpr std::uint32_t builtInGlobalInvocationId{ 28 };
+    constexpr std::uint32_t storageInput{ 1 };
+    constexpr std::uint32_t storageUniform{ 2 };
+    // "main" and its terminator, little-endian.
+    constexpr std::uint32_t entryPointName[]{ 0x6e69616d, 0x00000000 };
+
+    class SpirvWriter {
+    public:
+        SpirvWriter() { words_.assign({ 0x07230203, 0x00010000, 0, 0, 0 }); }
+
+        std::uint32_t id() { return next_++; }
+
+        void emit(std::uint32_t opcode, std::initializer_list<std::uint32_t> operands) {
+            words_.push_back(static_cast<std::uint32_t>(operands.size() + 1) << 16 | opcode);
+            words_.insert(words_.end(), operands);
+        }
+
+        // Returns the result id of an instruction that has a result type.
+        std::uint32_t value(std::uint32_t opcode, std::uint32_t type, std::initializer_list<std::uint32_t> operands) {
+            const std::uint32_t result{ id() };
+            words_.push_back(static_cast<std::uint32_t>(operands.size() + 3) << 16 | opcode);
+            words_.push_back(type);
+            words_.push_back(result);
+            words_.insert(words_.end(), operands);
+            return result;
+        }
+
+        std::vector<std::uint32_t> finish() {
+            words_[3] = next_;
+            return std::move(words_);
+        }
+
+    private:
+        std::vector<std::uint32_t> words_;
+        std::uint32_t next_{ 1 };
+    };
+}
+
+std::vector<std::uint32_t> shw::buildXorshiftShader(std::uint32_t localSize, std::uint32_t rounds, std::uint32_t salt) {
+    SpirvWriter spirv;
+    const std::uint32_t main{ spirv.id() };
+    const std::uint32_t invocationId{ spirv.id() };
+    const std::uint32_t buffer{ spirv.id() };
+    const std::uint32_t voidType{ spirv.id() };
+    const std::uint32_t functionType{ spirv.id() };
+    const std::uint32_t uintType{ spirv.id() };
+    const std::uint32_t uvec3Type{ spirv.id() };
+    const std::uint32_t inputPointer{ spirv.id() };
+    const std::uint32_t arrayType{ spirv.id() };
+    const std::uint32_t blockType{ spirv.id() };
+    const std::uint32_t blockPointer{ spirv.id() };
+    const std::uint32_t elementPointer{ spirv.id() };
+
+    spirv.emit(op::Capability, { capabilityShader });
+    spirv.emit(op::MemoryModel, { addressingLogical, memoryModelGlsl450 });
+    spirv.emit(op::EntryPoint, { executionModelGlCompute, main, entryPointName[0], entryPointName[1], invocationId });
+    spirv.emit(op::ExecutionMode, { main, executionModeLocalSize, localSize, 1, 1 });
+    spirv.emit(op::Decorate, { invocationId, decorationBuiltIn, builtInGlobalInvocationId });
+    spirv.emit(op::Decorate, { arrayType, decorationArrayStride, sizeof(std::uint32_t) });
+    spirv.emit(op::MemberDecorate, { blockType, 0, decorationOffset, 0 });
+    spirv.emit(op::Decorate, { blockType, decorationBufferBlock });
+    spirv.emit(op::Decorate, { buffer, decorationDescriptorSet, 0 });
+    spirv.emit(op::Decorate, { buffer, decorationBinding, 0 });
+
+    spirv.emit(op::TypeVoid, { voidType });
+    spirv.emit(op::TypeFunction, { functionType, voidType });
+    spirv.emit(op::TypeInt, { uintType, 32, 0 });
+    spirv.emit(op::TypeVector, { uvec3Type, uintType, 3 });
+    spirv.emit(op::TypePointer, { inputPointer, storageInput, uvec3Type });
+    spirv.emit(op::Variable, { inputPointer, invocationId, storageInput });
+    spirv.emit(op::TypeRuntimeArray, { arrayType, uintType });
+    spirv.emit(op::TypeStruct, { blockType, arrayType });
+    spirv.emit(op::TypePointer, { blockPointer, storageUniform, blockType });
+    spirv.emit(op::Variable, { blockPointer, buffer, storageUniform });
+    spirv.emit(op::TypePointer, { elementPointer, storageUniform, uintType });
+    const std::uint32_t zero{ spirv.value(op::Constant, uintType, { 0 }) };
+    const std::uint32_t saltConstant{ spirv.value(op::Constant, uintType, { salt }) };
+    const std::uint32_t shift13{ spirv.value(op::Constant, uintType, { 13 }) };
+    const std::uint32_t shift17{ spirv.value(op::Constant, uintType, { 17 }) };
+    const std::uint32_t shift5{ spirv.value(op::Constant, uintType, { 5 }) };
+
+    spirv.emit(op::Function, { voidType, main, 0, functionType });
+    spirv.emit(op::Label, { spirv.id() });
+    const std::uint32_t id{ spirv.value(op::Load, uvec3Type, { invocationId }) };
+    const std::uint32_t index{ spirv.value(op::CompositeExtract, uintType, { id, 0 }) };
+    std::uint32_t state{ spirv.value(op::BitwiseXor, uintType, { index, saltConstant }) };
+    for (std::uint32_t i{}; i < rounds; ++i) {
+        for (const auto& [shift, amount] : { std::pair{ op::ShiftLeftLogical, shift13 },
+                std::pair{ op::ShiftRightLogical, shift17 }, std::pair{ op::ShiftLeftLogical, shift5 } }) {
+            const std::uint32_t shifted{ spirv.value(shift, uintType, { state, amount }) };
+            state = spirv.value(op::BitwiseXor, uintType, { state, shifted });
+        }
+    }
+    const std::uint32_t element{ spirv.value(op::AccessChain, elementPointer, { buffer, zero, index }) };
+    spirv.emit(op::Store, { element, state });
+    spirv.emit(op::Return, {});
+    spirv.emit(op::FunctionEnd, {});
+    return spirv.finish();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace shw {
+    // SPIR-V 1.0 for a GLSL450 compute shader with an empty main() and a
+    // 1x1x1 workgroup, so that a dispatch measures nothing but its own cost:
+    //
+    //     OpCapability Shader
+    //     OpMemoryModel Logical GLSL450
+    //     OpEntryPoint GLCompute %main "main"
+    //     OpExecutionMode %main LocalSize 1 1 1
+    //     %void = OpTypeVoid
+    //     %fn = OpTypeFunction %void
+    //     %main = OpFunction %void None %fn
+    //     %entry = OpLabel
+    //     OpReturn
+    //     OpFunctionEnd
+    inline constexpr std::uint32_t emptyComputeShader[]{
+        0x07230203, 0x00010000, 0x00000000, 5, 0,
+        0x00020011, 1,
+        0x0003000e, 0, 1,
+        0x0005000f, 5, 1, 0x6e69616d, 0x00000000,
+        0x00060010, 1, 17, 1, 1, 1,
+        0x00020013, 2,
+        0x00030021, 3, 2,
+        0x00050036, 2, 1, 0, 3,
+        0x000200f8, 4,
+        0x000100fd,
+        0x00010038,
+    };
+
+    // SPIR-V 1.0 for a compute shader with a localSize x 1 x 1 workgroup that
+    // runs rounds of xorshift on gl_GlobalInvocationID.x ^ salt and stores the
+    // result at that index of the storage buffer in set 0, binding 0. Each
+    // salt gives a distinct module, so drivers cannot serve it from a cache
+    // of their own.
+    std::vector<std::uint32_t> buildXorshiftShader(std::uint32_t localSize, std::uint32_t rounds, std::uint32_t salt);
+}
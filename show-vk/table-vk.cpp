@@ -0,0 +1,441 @@
+#include "table-vk.h"
+#include "trace-vk.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+    // CBOR major types (RFC 8949).
+    constexpr std::uint8_t cborUnsigned{ 0 };
+    constexpr std::uint8_t cborNegative{ 1 };
+    constexpr std::uint8_t cborText{ 3 };
+    constexpr std::uint8_t cborArray{ 4 };
+    constexpr std::uint8_t cborMap{ 5 };
+    constexpr char cborIndefiniteArray{ '\x9f' };
+    constexpr char cborIndefiniteMap{ '\xbf' };
+    constexpr char cborBreak{ '\xff' };
+    constexpr char cborFalse{ '\xf4' };
+    constexpr char cborTrue{ '\xf5' };
+    constexpr char cborFloat64{ '\xfb' };
+
+    void writeCborHead(shw::OutputBuffer& out, std::uint8_t major, std::uint64_t value) {
+        char head[9];
+        std::size_t size{ 1 };
+        int bytes{};
+        if (value < 24) {
+            head[0] = static_cast<char>(major << 5 | value);
+        }
+        else if (value <= 0xff) {
+            head[0] = static_cast<char>(major << 5 | 24);
+            bytes = 1;
+        }
+        else if (value <= 0xffff) {
+            head[0] = static_cast<char>(major << 5 | 25);
+            bytes = 2;
+        }
+        else if (value <= 0xffffffff) {
+            head[0] = static_cast<char>(major << 5 | 26);
+            bytes = 4;
+        }
+        else {
+            head[0] = static_cast<char>(major << 5 | 27);
+            bytes = 8;
+        }
+        for (int i{ bytes - 1 }; i >= 0; --i) {
+            head[size++] = static_cast<char>(value >> (i * 8));
+        }
+        out.append({ head, size });
+    }
+
+    void writeCborText(shw::OutputBuffer& out, std::string_view text) {
+        writeCborHead(out, cborText, text.size());
+        out.append(text);
+    }
+
+    void writeJsonString(shw::OutputBuffer& out, std::string_view text) {
+        constexpr char hexDigits[]{ "0123456789abcdef" };
+        out.append('"');
+        std::size_t begin{};
+        for (std::size_t i{}, length{ text.size() }; i < length; ++i) {
+            const auto c{ static_cast<unsigned char>(text[i]) };
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            out.append(text.substr(begin, i - begin));
+            begin = i + 1;
+            switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\t': out.append("\\t"); break;
+            case '\r': out.append("\\r"); break;
+            default: {
+                const char escape[]{ '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xf] };
+                out.append({ escape, sizeof(escape) });
+            }
+            }
+        }
+        out.append(text.substr(begin));
+        out.append('"');
+    }
+
+    void writeJsonSeparator(shw::OutputBuffer& out) {
+        if (out.needsSeparator()) {
+            out.append(',');
+        }
+    }
+
+    void writeKey(shw::OutputBuffer& out, std::string_view key) {
+        if (key.empty()) {
+            return;
+        }
+        if (out.format() == shw::OutputFormat::Json) {
+            writeJsonSeparator(out);
+            writeJsonString(out, key);
+            out.append(':');
+            out.setNeedsSeparator(false);
+        }
+        else {
+            writeCborText(out, key);
+        }
+    }
+
+    void writeJsonValue(shw::OutputBuffer& out, const shw::Cell& cell) {
+        shw::CellBuffer buffer;
+        writeJsonSeparator(out);
+        switch (cell.kind) {
+        case shw::Cell::Kind::Text:
+        case shw::Cell::Kind::Version:
+        case shw::Cell::Kind::Custom:
+            writeJsonString(out, shw::formatCell(cell, buffer));
+            break;
+        case shw::Cell::Kind::Hex:
+            // Bitmaps go out as plain numbers; the 0x prefix is for humans.
+            out.append({ buffer.data(), static_cast<std::size_t>(
+                std::to_chars(buffer.data(), buffer.data() + buffer.size(), cell.unsignedValue).ptr - buffer.data()) });
+            break;
+        case shw::Cell::Kind::Float: {
+            if (!std::isfinite(cell.floatValue)) {
+                out.append("null");
+                break;
+            }
+            // Enough digits to read back the same double; %g is for humans.
+            const int length{ std::snprintf(buffer.data(), buffer.size(), "%.17g", cell.floatValue) };
+            out.append({ buffer.data(), static_cast<std::size_t>(std::clamp(length, 0, static_cast<int>(buffer.size()) - 1)) });
+            break;
+        }
+        case shw::Cell::Kind::Unsigned:
+        case shw::Cell::Kind::Signed:
+            out.append(shw::formatCell(cell, buffer));
+            break;
+        case shw::Cell::Kind::Bool:
+            out.append(cell.unsignedValue ? std::string_view{ "true" } : std::string_view{ "false" });
+            break;
+        }
+        out.setNeedsSeparator(true);
+    }
+
+    void writeCborValue(shw::OutputBuffer& out, const shw::Cell& cell) {
+        switch (cell.kind) {
+        case shw::Cell::Kind::Text:
+            writeCborText(out, cell.text);
+            break;
+        case shw::Cell::Kind::Version:
+        case shw::Cell::Kind::Custom: {
+            shw::CellBuffer buffer;
+            writeCborText(out, shw::formatCell(cell, buffer));
+            break;
+        }
+        case shw::Cell::Kind::Unsigned:
+        case shw::Cell::Kind::Hex:
+            writeCborHead(out, cborUnsigned, cell.unsignedValue);
+            break;
+        case shw::Cell::Kind::Signed:
+            if (cell.signedValue < 0) {
+                writeCborHead(out, cborNegative, static_cast<std::uint64_t>(-(cell.signedValue + 1)));
+            }
+            else {
+                writeCborHead(out, cborUnsigned, static_cast<std::uint64_t>(cell.signedValue));
+            }
+            break;
+        case shw::Cell::Kind::Float: {
+            std::uint64_t bits{};
+            std::memcpy(&bits, &cell.floatValue, sizeof(bits));
+            char value[9]{ cborFloat64 };
+            for (int i{}; i < 8; ++i) {
+                value[1 + i] = static_cast<char>(bits >> ((7 - i) * 8));
+            }
+            out.append({ value, sizeof(value) });
+            break;
+        }
+        case shw::Cell::Kind::Bool:
+            out.append(cell.unsignedValue ? cborTrue : cborFalse);
+            break;
+        }
+    }
+
+    void writeValue(shw::OutputBuffer& out, const shw::Cell& cell) {
+        if (out.format() == shw::OutputFormat::Json) {
+            writeJsonValue(out, cell);
+        }
+        else {
+            writeCborValue(out, cell);
+        }
+    }
+
+    // Opens a container whose size is only known once it is closed.
+    void beginContainer(shw::OutputBuffer& out, std::string_view key, char json, char cbor) {
+        writeKey(out, key);
+        if (out.format() == shw::OutputFormat::Json) {
+            writeJsonSeparator(out);
+            out.append(json);
+            out.setNeedsSeparator(false);
+        }
+        else {
+            out.append(cbor);
+        }
+    }
+
+    void endContainer(shw::OutputBuffer& out, char json) {
+        if (out.format() == shw::OutputFormat::Json) {
+            out.append(json);
+            out.setNeedsSeparator(true);
+        }
+        else {
+            out.append(cborBreak);
+        }
+    }
+}
+
+void shw::OutputBuffer::flush() {
+    if (data_.empty()) {
+        return;
+    }
+    const TraceScope scope{ "flushOutput" };
+    const bool written{ sink_ == nullptr
+        || (std::fwrite(data_.data(), 1, data_.size(), sink_) == data_.size() && std::fflush(sink_) == 0) };
+    data_.clear();
+    if (!written) {
+        // A closed pipe or a full disk; later flushes go nowhere.
+        sink_ = nullptr;
+        throw std::runtime_error{ "Cannot write the output" };
+    }
+}
+
+shw::OutputBuffer& shw::output() {
+    static OutputBuffer buffer;
+    return buffer;
+}
+
+std::string_view shw::formatCell(const Cell& cell, CellBuffer& buffer) {
+    char* const begin{ buffer.data() };
+    char* const end{ buffer.data() + buffer.size() };
+    char* last{ begin };
+    switch (cell.kind) {
+    case Cell::Kind::Text:
+        return cell.text;
+    case Cell::Kind::Unsigned:
+        last = std::to_chars(begin, end, cell.unsignedValue).ptr;
+        break;
+    case Cell::Kind::Signed:
+        last = std::to_chars(begin, end, cell.signedValue).ptr;
+        break;
+    case Cell::Kind::Float: {
+        const int length{ std::snprintf(begin, buffer.size(), "%g", cell.floatValue) };
+        last = begin + std::clamp(length, 0, static_cast<int>(buffer.size()) - 1);
+        break;
+    }
+    case Cell::Kind::Hex:
+        *last++ = '0';
+        *last++ = 'x';
+        last = std::to_chars(last, end, cell.unsignedValue, 16).ptr;
+        break;
+    case Cell::Kind::Version: {
+        const auto version{ static_cast<std::uint32_t>(cell.unsignedValue) };
+        last = std::to_chars(last, end, VK_API_VERSION_VARIANT(version)).ptr;
+        *last++ = '.';
+        last = std::to_chars(last, end, VK_API_VERSION_MAJOR(version)).ptr;
+        *last++ = '.';
+        last = std::to_chars(last, end, VK_API_VERSION_MINOR(version)).ptr;
+        *last++ = '.';
+        last = std::to_chars(last, end, VK_API_VERSION_PATCH(version)).ptr;
+        break;
+    }
+    case Cell::Kind::Bool:
+        return cell.unsignedValue ? "YES" : "NO";
+    case Cell::Kind::Custom:
+        return cell.format(cell, buffer);
+    }
+    return { begin, static_cast<std::size_t>(last - begin) };
+}
+
+void shw::CellWriter::append(std::string_view text) {
+    const std::size_t size{ std::min(text.size(), static_cast<std::size_t>(end_ - last_)) };
+    std::memcpy(last_, text.data(), size);
+    last_ += size;
+}
+
+void shw::CellWriter::appendNumber(std::uint64_t value) {
+    const auto result{ std::to_chars(last_, end_, value) };
+    if (result.ec == std::errc{}) {
+        last_ = result.ptr;
+    }
+}
+
+void shw::CellWriter::appendNumber(std::int64_t value) {
+    const auto result{ std::to_chars(last_, end_, value) };
+    if (result.ec == std::errc{}) {
+        last_ = result.ptr;
+    }
+}
+
+void shw::CellWriter::appendNumber(double value) {
+    if (last_ == end_) {
+        return;
+    }
+    const int length{ std::snprintf(last_, static_cast<std::size_t>(end_ - last_), "%g", value) };
+    last_ += std::clamp(length, 0, static_cast<int>(end_ - last_) - 1);
+}
+
+void shw::CellWriter::appendHex(std::uint64_t value, int digits) {
+    char hex[16];
+    const std::size_t size{ static_cast<std::size_t>(std::to_chars(hex, hex + sizeof(hex), value, 16).ptr - hex) };
+    for (std::size_t i{ size }; i < static_cast<std::size_t>(digits); ++i) {
+        append('0');
+    }
+    append({ hex, size });
+}
+
+void shw::writeCell(OutputBuffer& out, std::string_view value, std::size_t width, Align align, bool last) {
+    const std::size_t padding{ width > value.size() ? width - value.size() : 0 };
+    if (align == Align::Right) {
+        out.append(padding, ' ');
+        out.append(value);
+    }
+    else {
+        out.append(value);
+        // No trailing blanks after the last column.
+        if (!last) {
+            out.append(padding, ' ');
+        }
+    }
+    if (last) {
+        out.append('\n');
+    }
+    else {
+        out.append(tableColumnGap, ' ');
+    }
+}
+
+void shw::beginDocument(OutputBuffer& out) {
+    if (out.format() != OutputFormat::Text) {
+        out.setNeedsSeparator(false);
+        beginContainer(out, {}, '{', cborIndefiniteMap);
+    }
+}
+
+void shw::endDocument(OutputBuffer& out) {
+    if (out.format() != OutputFormat::Text) {
+        endContainer(out, '}');
+        if (out.format() == OutputFormat::Json) {
+            out.append('\n');
+        }
+    }
+}
+
+void shw::beginObject(OutputBuffer& out, std::string_view key) {
+    if (out.format() != OutputFormat::Text) {
+        beginContainer(out, key, '{', cborIndefiniteMap);
+    }
+}
+
+void shw::endObject(OutputBuffer& out) {
+    if (out.format() != OutputFormat::Text) {
+        endContainer(out, '}');
+    }
+}
+
+void shw::beginList(OutputBuffer& out, std::string_view key) {
+    if (out.format() != OutputFormat::Text) {
+        beginContainer(out, key, '[', cborIndefiniteArray);
+    }
+}
+
+void shw::endList(OutputBuffer& out) {
+    if (out.format() != OutputFormat::Text) {
+        endContainer(out, ']');
+    }
+}
+
+void shw::writeField(OutputBuffer& out, std::string_view key, std::string_view label, const Cell& cell) {
+    if (out.format() == OutputFormat::Text) {
+        if (!label.empty()) {
+            CellBuffer buffer;
+            out.append(label);
+            out.append(formatCell(cell, buffer));
+            out.append('\n');
+        }
+        return;
+    }
+    writeKey(out, key);
+    writeValue(out, cell);
+}
+
+void shw::beginTable(OutputBuffer& out, std::string_view key, std::size_t rowCount) {
+    if (out.format() == OutputFormat::Json) {
+        beginContainer(out, key, '[', cborIndefiniteArray);
+    }
+    else {
+        writeKey(out, key);
+        writeCborHead(out, cborArray, rowCount);
+    }
+}
+
+void shw::beginRow(OutputBuffer& out, std::size_t columnCount) {
+    if (out.format() == OutputFormat::Json) {
+        beginContainer(out, {}, '{', cborIndefiniteMap);
+    }
+    else {
+        writeCborHead(out, cborMap, columnCount);
+    }
+}
+
+void shw::writeRowCell(OutputBuffer& out, std::string_view key, const Cell& cell) {
+    writeKey(out, key);
+    writeValue(out, cell);
+}
+
+void shw::endRow(OutputBuffer& out) {
+    // CBOR rows and tables carry their size up front and need no terminator.
+    if (out.format() == OutputFormat::Json) {
+        endContainer(out, '}');
+    }
+}
+
+void shw::endTable(OutputBuffer& out) {
+    if (out.format() == OutputFormat::Json) {
+        endContainer(out, ']');
+    }
+}
+
+void shw::endSection(OutputBuffer& out) {
+    if (out.format() != OutputFormat::Text) {
+        out.flush();
+    }
+}
+
+bool shw::parseOutputFormat(std::string_view name, OutputFormat& format) {
+    if (name == "text") {
+        format = OutputFormat::Text;
+    } else if (name == "json") {
+        format = OutputFormat::Json;
+    } else if (name == "cbor") {
+        format = OutputFormat::Cbor;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <vulkan/vulkan.h>
+
+namespace shw {
+    enum class OutputFormat { Text, Json, Cbor };
+
+    // Everything show-vk prints is appended here and reaches stdout in a single
+    // write when flushed. The storage is kept between flushes, so steady-state
+    // rendering does not allocate.
+    class OutputBuffer {
+    public:
+        void append(std::string_view text) { data_.append(text.data(), text.size()); }
+        void append(char c) { data_.push_back(c); }
+        void append(std::size_t count, char c) { data_.append(count, c); }
+        void reserve(std::size_t extra) { data_.reserve(data_.size() + extra); }
+        std::size_t size() const { return data_.size(); }
+        // Throws when the sink cannot be written, e.g. a full disk.
+        void flush();
+        // Drops pending output without writing it; the storage is kept.
+        void clear() { data_.clear(); needsSeparator_ = false; }
+        // Where flush() writes, stdout by default. A null sink discards.
+        void setSink(std::FILE* sink) { sink_ = sink; }
+
+        OutputFormat format() const { return format_; }
+        void setFormat(OutputFormat format) { format_ = format; }
+        // JSON only: whether the next value has to be preceded by a comma.
+        bool needsSeparator() const { return needsSeparator_; }
+        void setNeedsSeparator(bool needsSeparator) { needsSeparator_ = needsSeparator; }
+
+    private:
+        std::string data_;
+        std::FILE* sink_{ stdout };
+        OutputFormat format_{ OutputFormat::Text };
+        bool needsSeparator_{};
+    };
+
+    OutputBuffer& output();
+
+    // Flushes the global output buffer when it goes out of scope, including
+    // on the way out of an exception. Write errors are dropped here; the
+    // normal path flushes explicitly first so that they are reported.
+    struct OutputFlushGuard {
+        ~OutputFlushGuard() {
+            try {
+                output().flush();
+            }
+            catch (const std::exception&) {
+            }
+        }
+    };
+
+    enum class Align { Left, Right };
+
+    // Large enough for any non-text cell, flag lists included.
+    using CellBuffer = std::array<char, 256>;
+
+    // Typed value of one table cell. Text cells point into the row they came
+    // from; numbers are formatted into a stack buffer when rendered.
+    struct Cell {
+        enum class Kind { Text, Unsigned, Signed, Float, Hex, Version, Bool, Custom };
+        using Formatter = std::string_view (*)(const Cell& cell, CellBuffer& buffer);
+
+        Kind kind{ Kind::Text };
+        std::string_view text;
+        std::uint64_t unsignedValue{};
+        std::int64_t signedValue{};
+        double floatValue{};
+        // Custom cells: what format() reads besides unsignedValue, such as a
+        // UUID or an array of limits. It has to outlive the rendering.
+        const void* data{};
+        Formatter format{};
+
+        static constexpr Cell str(std::string_view value) { Cell cell{}; cell.text = value; return cell; }
+        // Vulkan name/description arrays are not guaranteed to be NUL terminated.
+        template<std::size_t N>
+        static Cell fixed(const char (&value)[N]) {
+            const void* end{ std::memchr(value, '\0', N) };
+            return str({ value, end != nullptr ? static_cast<std::size_t>(static_cast<const char*>(end) - value) : N });
+        }
+        static constexpr Cell number(std::uint64_t value) { Cell cell{}; cell.kind = Kind::Unsigned; cell.unsignedValue = value; return cell; }
+        static constexpr Cell signedNumber(std::int64_t value) { Cell cell{}; cell.kind = Kind::Signed; cell.signedValue = value; return cell; }
+        static constexpr Cell real(double value) { Cell cell{}; cell.kind = Kind::Float; cell.floatValue = value; return cell; }
+        static constexpr Cell hex(std::uint64_t value) { Cell cell{}; cell.kind = Kind::Hex; cell.unsignedValue = value; return cell; }
+        static constexpr Cell version(std::uint32_t value) { Cell cell{}; cell.kind = Kind::Version; cell.unsignedValue = value; return cell; }
+        static constexpr Cell yesNo(bool value) { Cell cell{}; cell.kind = Kind::Bool; cell.unsignedValue = value; return cell; }
+        // Formatted by the caller's function; machine formats get the text.
+        static constexpr Cell custom(Formatter format, const void* data, std::uint64_t value = 0) {
+            Cell cell{};
+            cell.kind = Kind::Custom;
+            cell.unsignedValue = value;
+            cell.data = data;
+            cell.format = format;
+            return cell;
+        }
+    };
+
+    std::string_view formatCell(const Cell& cell, CellBuffer& buffer);
+
+    // Appends to a CellBuffer for custom cells, dropping what does not fit.
+    class CellWriter {
+    public:
+        explicit CellWriter(CellBuffer& buffer) : begin_{ buffer.data() }, last_{ begin_ }, end_{ begin_ + buffer.size() } {}
+
+        void append(std::string_view text);
+        void append(char c) { append(std::string_view{ &c, 1 }); }
+        void appendNumber(std::uint64_t value);
+        void appendNumber(std::int64_t value);
+        void appendNumber(double value);
+        void appendHex(std::uint64_t value, int digits = 0);
+        bool empty() const { return last_ == begin_; }
+        std::string_view text() const { return { begin_, static_cast<std::size_t>(last_ - begin_) }; }
+
+    private:
+        char* begin_;
+        char* last_;
+        char* end_;
+    };
+
+    // Compile-time description of one column: its key in JSON/CBOR, its text
+    // header, alignment and how to pull the cell out of a row.
+    template<typename Row>
+    struct Column {
+        std::string_view key;
+        std::string_view header;
+        Align align;
+        Cell (*get)(const Row& row);
+    };
+
+    constexpr std::string_view tableIndent{ "\t" };
+    constexpr std::size_t tableColumnGap{ 5 };
+
+    void writeCell(OutputBuffer& out, std::string_view value, std::size_t width, Align align, bool last);
+
+    // Structure of the machine readable output. The document is a map of
+    // sections; tables are arrays of row maps. In text mode only labelled
+    // fields and table titles produce output.
+    void beginDocument(OutputBuffer& out);
+    void endDocument(OutputBuffer& out);
+    // An empty key starts an element of the enclosing list.
+    void beginObject(OutputBuffer& out, std::string_view key);
+    void endObject(OutputBuffer& out);
+    void beginList(OutputBuffer& out, std::string_view key);
+    void endList(OutputBuffer& out);
+    void writeField(OutputBuffer& out, std::string_view key, std::string_view label, const Cell& cell);
+    void beginTable(OutputBuffer& out, std::string_view key, std::size_t rowCount);
+    void beginRow(OutputBuffer& out, std::size_t columnCount);
+    void writeRowCell(OutputBuffer& out, std::string_view key, const Cell& cell);
+    void endRow(OutputBuffer& out);
+    void endTable(OutputBuffer& out);
+    // Machine formats are streamed: each finished section is written out
+    // right away instead of waiting for the end of the run.
+    void endSection(OutputBuffer& out);
+
+    bool parseOutputFormat(std::string_view name, OutputFormat& format);
+
+    // Renders a table under key (machine formats) or title (text) into out.
+    // Text widths are measured in a first pass, then every cell is formatted
+    // straight into the buffer.
+    template<typename Row, std::size_t N>
+    void renderTable(OutputBuffer& out, std::string_view key, std::string_view title,
+            const Column<Row> (&columns)[N], const Row* rows, std::size_t count) {
+        if (out.format() != OutputFormat::Text) {
+            beginTable(out, key, count);
+            for (std::size_t r{}; r < count; ++r) {
+                beginRow(out, N);
+                for (std::size_t c{}; c < N; ++c) {
+                    writeRowCell(out, columns[c].key, columns[c].get(rows[r]));
+                }
+                endRow(out);
+            }
+            endTable(out);
+            endSection(out);
+            return;
+        }
+        CellBuffer buffer;
+        std::array<std::size_t, N> widths{};
+        for (std::size_t c{}; c < N; ++c) {
+            widths[c] = columns[c].header.size();
+        }
+        for (std::size_t r{}; r < count; ++r) {
+            for (std::size_t c{}; c < N; ++c) {
+                widths[c] = std::max(widths[c], formatCell(columns[c].get(rows[r]), buffer).size());
+            }
+        }
+        std::size_t lineWidth{ tableIndent.size() + tableColumnGap * (N - 1) + 1 };
+        for (std::size_t width : widths) {
+            lineWidth += width;
+        }
+        out.reserve(title.size() + lineWidth * (count + 1));
+        out.append(title);
+        out.append(tableIndent);
+        for (std::size_t c{}; c < N; ++c) {
+            writeCell(out, columns[c].header, widths[c], columns[c].align, c + 1 == N);
+        }
+        for (std::size_t r{}; r < count; ++r) {
+            out.append(tableIndent);
+            for (std::size_t c{}; c < N; ++c) {
+                writeCell(out, formatCell(columns[c].get(rows[r]), buffer), widths[c], columns[c].align, c + 1 == N);
+            }
+        }
+    }
+
+    template<typename Row, std::size_t N>
+    void renderTable(OutputBuffer& out, std::string_view key, std::string_view title,
+            const Column<Row> (&columns)[N], const std::vector<Row>& rows) {
+        renderTable(out, key, title, columns, rows.data(), rows.size());
+    }
+
+    inline constexpr Column<VkExtensionProperties> extensionColumns[]{
+        { "name", "Name", Align::Left, [](const VkExtensionProperties& extension) { return Cell::fixed(extension.extensionName); } },
+        { "specVersion", "Spec Version", Align::Right, [](const VkExtensionProperties& extension) { return Cell::number(extension.specVersion); } },
+    };
+
+    inline constexpr Column<VkLayerProperties> layerColumns[]{
+        { "name", "Name", Align::Left, [](const VkLayerProperties& layer) { return Cell::fixed(layer.layerName); } },
+        { "specVersion", "Spec Version", Align::Right, [](const VkLayerProperties& layer) { return Cell::number(layer.specVersion); } },
+        { "implementationVersion", "Implementation Version", Align::Right, [](const VkLayerProperties& layer) { return Cell::number(layer.implementationVersion); } },
+        { "description", "Description", Align::Left, [](const VkLayerProperties& layer) { return Cell::fixed(layer.description); } },
+    };
+
+    // Row type for the --instance-support-* answers.
+    struct SupportRow {
+        std::string_view name;
+        bool supported;
+    };
+
+    inline constexpr Column<SupportRow> supportColumns[]{
+        { "name", "Name", Align::Left, [](const SupportRow& row) { return Cell::str(row.name); } },
+        { "supported", "Supported", Align::Left, [](const SupportRow& row) { return Cell::yesNo(row.supported); } },
+    };
+
+    // Row type for name/value listings such as device properties and limits.
+    struct NameValueRow {
+        std::string_view name;
+        Cell value;
+    };
+
+    inline constexpr Column<NameValueRow> nameValueColumns[]{
+        { "name", "Name", Align::Left, [](const NameValueRow& row) { return Cell::str(row.name); } },
+        { "value", "Value", Align::Left, [](const NameValueRow& row) { return row.value; } },
+    };
+}
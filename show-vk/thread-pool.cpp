@@ -0,0 +1,92 @@
+#include "thread-pool.h"
+
+#include <algorithm>
+
+shw::ThreadPool::ThreadPool(std::size_t threadCount) {
+    threadCount = std::max<std::size_t>(threadCount, 1);
+    threads_.reserve(threadCount - 1);
+    for (std::size_t i{ 1 }; i < threadCount; ++i) {
+        threads_.emplace_back([this] { work(); });
+    }
+}
+
+shw::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+std::size_t shw::ThreadPool::defaultThreadCount() {
+    constexpr std::size_t maxThreads{ 8 };
+    return std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, maxThreads);
+}
+
+void shw::ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (threads_.empty() || count <= 1) {
+        for (std::size_t i{}; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        task_ = &task;
+        count_ = count;
+        next_ = 0;
+        finished_ = 0;
+        error_ = nullptr;
+        ++generation_;
+    }
+    wake_.notify_all();
+    runTasks();
+
+    // Every worker acknowledges every generation, so none of them can still
+    // be holding on to task once we return.
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock{ mutex_ };
+        done_.wait(lock, [this] { return finished_ == threads_.size(); });
+        task_ = nullptr;
+        std::swap(error, error_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void shw::ThreadPool::work() {
+    std::uint64_t seen{};
+    std::unique_lock<std::mutex> lock{ mutex_ };
+    for (;;) {
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) {
+            return;
+        }
+        seen = generation_;
+        lock.unlock();
+        runTasks();
+        lock.lock();
+        if (++finished_ == threads_.size()) {
+            done_.notify_one();
+        }
+    }
+}
+
+void shw::ThreadPool::runTasks() {
+    for (std::size_t i{ next_++ }; i < count_; i = next_++) {
+        try {
+            (*task_)(i);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock{ mutex_ };
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+    }
+}
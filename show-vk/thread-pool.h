@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace shw {
+    // Small fixed-size pool used to fan independent Vulkan queries out across
+    // devices. The calling thread takes part in the work, so a pool of size 1
+    // runs everything inline.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(std::size_t threadCount = defaultThreadCount());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Runs task(i) for every i in [0, count) and returns once all of them
+        // finished. The first exception thrown by a task is rethrown here.
+        // Not reentrant: task must not call parallelFor on the same pool.
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+        std::size_t size() const { return threads_.size() + 1; }
+
+        static std::size_t defaultThreadCount();
+
+    private:
+        void work();
+        void runTasks();
+
+        std::vector<std::thread> threads_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        const std::function<void(std::size_t)>* task_{};
+        std::size_t count_{};
+        std::atomic<std::size_t> next_{};
+        std::size_t finished_{};
+        std::uint64_t generation_{};
+        bool stop_{};
+        std::exception_ptr error_;
+    };
+}
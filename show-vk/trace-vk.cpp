@@ -0,0 +1,111 @@
+#include "trace-vk.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+    struct TraceEvent {
+        std::string_view name;
+        std::string_view category;
+        std::uint64_t start;
+        std::uint64_t end;
+        std::uint32_t thread;
+    };
+
+    struct TraceState {
+        std::string path;
+        std::chrono::steady_clock::time_point epoch;
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+    };
+
+    TraceState& traceState() {
+        static TraceState state;
+        return state;
+    }
+
+    std::atomic<std::uint32_t> nextThreadIndex{};
+
+    // Small stable ids read better in the trace viewer than native thread ids.
+    std::uint32_t threadIndex() {
+        thread_local const std::uint32_t index{ nextThreadIndex.fetch_add(1) };
+        return index;
+    }
+
+    // Trace-event timestamps are in microseconds; keep the nanoseconds as decimals.
+    void appendMicroseconds(std::string& out, std::uint64_t nanoseconds) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%llu.%03u",
+            static_cast<unsigned long long>(nanoseconds / 1000), static_cast<unsigned>(nanoseconds % 1000));
+        out += buffer;
+    }
+}
+
+void shw::enableTrace(std::string_view path) {
+    TraceState& state{ traceState() };
+    state.path = path;
+    state.epoch = std::chrono::steady_clock::now();
+    state.events.reserve(4096);
+    // The thread that enables tracing is reported as thread 0.
+    threadIndex();
+    traceEnabled = true;
+}
+
+std::uint64_t shw::traceClock() {
+    const auto elapsed{ std::chrono::steady_clock::now() - traceState().epoch };
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void shw::recordTraceEvent(std::string_view name, std::string_view category, std::uint64_t start, std::uint64_t end) {
+    const std::uint32_t thread{ threadIndex() };
+    TraceState& state{ traceState() };
+    const std::lock_guard<std::mutex> lock{ state.mutex };
+    state.events.push_back({ name, category, start, end, thread });
+}
+
+void shw::writeTrace() {
+    if (!traceEnabled) {
+        return;
+    }
+    TraceState& state{ traceState() };
+    const std::lock_guard<std::mutex> lock{ state.mutex };
+
+    std::string json;
+    json.reserve(128 + state.events.size() * 112);
+    json += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    const std::uint32_t threads{ nextThreadIndex.load() };
+    for (std::uint32_t thread{}; thread < threads; ++thread) {
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        json += std::to_string(thread);
+        json += thread == 0 ? ",\"args\":{\"name\":\"main\"}},\n" : ",\"args\":{\"name\":\"worker\"}},\n";
+    }
+    // Names are Vulkan entry points and section names, which need no escaping.
+    for (const auto& event : state.events) {
+        json += "{\"name\":\"";
+        json.append(event.name);
+        json += "\",\"cat\":\"";
+        json.append(event.category);
+        json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+        json += std::to_string(event.thread);
+        json += ",\"ts\":";
+        appendMicroseconds(json, event.start);
+        json += ",\"dur\":";
+        appendMicroseconds(json, event.end - event.start);
+        json += "},\n";
+    }
+    if (json.back() == '\n' && json[json.size() - 2] == ',') {
+        json.erase(json.size() - 2, 1);
+    }
+    json += "]}\n";
+
+    std::ofstream out{ state.path, std::ios::binary | std::ios::trunc };
+    out.write(json.data(), static_cast<std::streamsize>(json.size()));
+    if (!out) {
+        std::fprintf(stderr, "Cannot write trace file: %s\n", state.path.c_str());
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace shw {
+    // Set by enableTrace() before any work starts and only read afterwards,
+    // so checking it is a plain load and a well predicted branch.
+    inline bool traceEnabled{};
+
+    // Starts recording events; writeTrace() saves them to path in Chrome
+    // trace-event format (chrome://tracing, Perfetto).
+    void enableTrace(std::string_view path);
+    // Does nothing unless tracing is enabled. Failures are reported on stderr
+    // rather than thrown, so this is safe to call while unwinding.
+    void writeTrace();
+
+    // Nanoseconds since enableTrace().
+    std::uint64_t traceClock();
+    // name and category must outlive the trace; string literals do.
+    void recordTraceEvent(std::string_view name, std::string_view category, std::uint64_t start, std::uint64_t end);
+
+    // Records the time between construction and destruction as one event.
+    class TraceScope {
+    public:
+        TraceScope(std::string_view name, std::string_view category = "show-vk")
+            : name_{ name }, category_{ category }, start_{ traceEnabled ? traceClock() : 0 } {}
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+        ~TraceScope() {
+            if (traceEnabled) {
+                recordTraceEvent(name_, category_, start_, traceClock());
+            }
+        }
+
+    private:
+        std::string_view name_;
+        std::string_view category_;
+        std::uint64_t start_;
+    };
+
+    // Writes the trace when it goes out of scope, including on the way out
+    // of an exception.
+    struct TraceWriteGuard {
+        ~TraceWriteGuard() { writeTrace(); }
+    };
+
+    // Calls function, timing it when tracing is enabled; see SHW_VK_CALL.
+    template<typename Function, typename... Args>
+    decltype(auto) tracedCall(std::string_view name, Function* function, Args&&... args) {
+        if (!traceEnabled) {
+            return function(std::forward<Args>(args)...);
+        }
+        const TraceScope scope{ name, "vulkan" };
+        return function(std::forward<Args>(args)...);
+    }
+}